@@ -126,4 +126,42 @@ libmysqlclient_thr_key_visible=yes
 ])
 fi
 
+# Check if the non-blocking client API (MariaDB) is available.
+#
+libmysqlclient_nonblocking=no
+
+if test x"$libmysqlclient_found" = xyes; then
+
+if test x"$libmysqlclient_include" = xshort; then
+  libmysqlclient_header="mysql.h"
+else
+  libmysqlclient_header="mysql/mysql.h"
+fi
+
+CXX_LIBTOOL_LINK_IFELSE([
+AC_LANG_SOURCE([
+#ifdef _WIN32
+#  include <winsock2.h>
+#endif
+#include <$libmysqlclient_header>
+
+int
+main ()
+{
+  MYSQL handle;
+  mysql_init (&handle);
+  mysql_options (&handle, MYSQL_OPT_NONBLOCK, 0);
+  int r;
+  int s = mysql_real_query_start (&r, &handle, "", 0);
+  s = mysql_real_query_cont (&r, &handle, s | MYSQL_WAIT_TIMEOUT);
+  s = s + static_cast<int> (mysql_get_socket (&handle));
+  mysql_close (&handle);
+  return s;
+}
+])],
+[
+libmysqlclient_nonblocking=yes
+])
+fi
+
 ])dnl
@@ -9,14 +9,23 @@
 #  include <pthread.h>
 #endif
 
+#include <ctime>   // std::time, std::difftime
 #include <cstdlib> // abort
+#include <exception>
+#include <algorithm> // std::find
 
+#ifndef _WIN32
+#  include <time.h>     // nanosleep
+#  include <sys/time.h> // gettimeofday
+#endif
+
+#include <odb/exception.hxx>
 #include <odb/details/tls.hxx>
 #include <odb/details/lock.hxx>
 
 #include <odb/mysql/mysql.hxx>
 #include <odb/mysql/connection-factory.hxx>
-#include <odb/mysql/exceptions.hxx>
+#include <odb/mysql/exceptions.hxx> // connection_timeout
 
 // This key is in the mysql client library. We use it to resolve the
 // following problem: Some pthread implementations zero-out slots that
@@ -126,6 +135,40 @@ namespace odb
       };
 
       static mysql_process_init mysql_process_init_;
+
+      static void
+      sleep_ms (unsigned int ms)
+      {
+#ifdef _WIN32
+        Sleep (ms);
+#else
+        timespec t;
+        t.tv_sec = ms / 1000;
+        t.tv_nsec = (ms % 1000) * 1000000L;
+        nanosleep (&t, 0);
+#endif
+      }
+
+      // Current time in milliseconds.
+      //
+      static unsigned long long
+      now_ms ()
+      {
+#ifdef _WIN32
+        FILETIME ft;
+        GetSystemTimeAsFileTime (&ft);
+
+        ULARGE_INTEGER t;
+        t.LowPart = ft.dwLowDateTime;
+        t.HighPart = ft.dwHighDateTime;
+        return static_cast<unsigned long long> (t.QuadPart / 10000);
+#else
+        timeval t;
+        gettimeofday (&t, 0);
+        return static_cast<unsigned long long> (t.tv_sec) * 1000 +
+          static_cast<unsigned long long> (t.tv_usec / 1000);
+#endif
+      }
     }
 
     // new_connection_factory
@@ -149,6 +192,8 @@ namespace odb
     connection_pool_factory::
     ~connection_pool_factory ()
     {
+      stop_maintenance ();
+
       // Wait for all the connections currently in use to return to
       // the pool.
       //
@@ -163,9 +208,18 @@ namespace odb
 
     connection_ptr connection_pool_factory::
     connect ()
+    {
+      return connect (connect_timeout_);
+    }
+
+    connection_ptr connection_pool_factory::
+    connect (size_t timeout)
     {
       tls_get (mysql_thread_init_);
 
+      unsigned long long start (now_ms ());
+      bool waited (false);
+
       // The outer loop checks whether the connection we were
       // given is still valid.
       //
@@ -201,25 +255,74 @@ namespace odb
             c = create ();
             c->callback_ = &c->cb_;
             in_use_++;
+            stats_.creations++;
+            stats_.record (now_ms () - start, waited);
             return c;
           }
 
+          waited = true;
+
           // Wait until someone releases a connection.
           //
-          waiters_++;
-          cond_.wait (l);
-          waiters_--;
+          if (timeout == 0)
+          {
+            waiters_++;
+            cond_.wait (l);
+            waiters_--;
+          }
+          else
+          {
+            unsigned long long t (now_ms () - start);
+
+            if (t >= timeout)
+            {
+              stats_.timeouts++;
+              throw connection_timeout ();
+            }
+
+            // There is no timed wait on the condition so we poll while
+            // still counting as a waiter (so that the released
+            // connections are kept). See connect(std::size_t) in the
+            // header for the implications.
+            //
+            unsigned int d (static_cast<unsigned int> (timeout - t));
+
+            waiters_++;
+            mutex_.unlock ();
+            sleep_ms (d < 10 ? d : 10);
+            mutex_.lock ();
+            waiters_--;
+          }
         }
 
         l.unlock ();
 
-        if (!ping_ || c->ping ())
+        // Only count the checkout once the connection has passed the
+        // ping. Otherwise it is dropped and we try again.
+        //
+        if (!need_ping (*c) || c->ping ())
+        {
+          lock sl (mutex_);
+          stats_.record (now_ms () - start, waited);
           return c;
+        }
       }
 
       return pooled_connection_ptr (); // Never reached.
     }
 
+    connection_pool_factory::statistics connection_pool_factory::
+    stats ()
+    {
+      lock l (mutex_);
+
+      statistics r (stats_);
+      r.in_use = in_use_;
+      r.idle = connections_.size ();
+      r.waiters = waiters_;
+      return r;
+    }
+
     void connection_pool_factory::
     database (database_type& db)
     {
@@ -232,12 +335,17 @@ namespace odb
       if (!first)
         return;
 
-      if (min_ > 0)
+      // If we have the maintenance thread, then it will open the initial
+      // connections.
+      //
+      if (min_ > 0 && !start_maintenance ())
       {
         connections_.reserve (min_);
 
         for(size_t i (0); i < min_; ++i)
           connections_.push_back (create ());
+
+        stats_.creations += min_;
       }
     }
 
@@ -260,6 +368,7 @@ namespace odb
 
       if (keep)
       {
+        c->released_ = c->checked_ = time (0);
         connections_.push_back (pooled_connection_ptr (inc_ref (c)));
         connections_.back ()->recycle ();
       }
@@ -270,13 +379,935 @@ namespace odb
       return !keep;
     }
 
+    bool connection_pool_factory::
+    need_ping (const pooled_connection& c) const
+    {
+      if (!ping_)
+        return false;
+
+      return ping_window_ == 0 ||
+        difftime (time (0), c.checked_) >= static_cast<double> (ping_window_);
+    }
+
+    void connection_pool_factory::
+    maintain ()
+    {
+      // Re-open connections up to min_connections.
+      //
+      while (true)
+      {
+        {
+          lock l (mutex_);
+
+          if (stop_ || connections_.size () + in_use_ >= min_)
+            break;
+
+          in_use_++; // Reserve the slot.
+        }
+
+        pooled_connection_ptr c;
+
+        try
+        {
+          c = create ();
+        }
+        catch (...)
+        {
+          lock l (mutex_);
+          in_use_--;
+
+          if (waiters_ != 0)
+            cond_.signal ();
+
+          throw;
+        }
+
+        lock l (mutex_);
+        in_use_--;
+        stats_.creations++;
+        connections_.push_back (c);
+
+        if (waiters_ != 0)
+          cond_.signal ();
+      }
+
+      bool ping (ping_ && ping_window_ != 0);
+
+      if (idle_timeout_ == 0 && !ping)
+        return;
+
+      // Go over the idle connections and sort out the ones that have
+      // been idle for too long and the ones that need to be pinged. The
+      // latter are counted as in use while we ping them.
+      //
+      time_t now (time (0));
+      connections close, check;
+
+      {
+        lock l (mutex_);
+
+        connections keep;
+        size_t total (connections_.size () + in_use_);
+
+        for (connections::iterator i (connections_.begin ());
+             i != connections_.end (); ++i)
+        {
+          pooled_connection& c (**i);
+
+          if (idle_timeout_ != 0 &&
+              total > min_ &&
+              difftime (now, c.released_) >=
+              static_cast<double> (idle_timeout_))
+          {
+            close.push_back (*i);
+            total--;
+          }
+          else if (ping &&
+                   difftime (now, c.checked_) >=
+                   static_cast<double> (ping_window_))
+            check.push_back (*i);
+          else
+            keep.push_back (*i);
+        }
+
+        connections_.swap (keep);
+        in_use_ += check.size ();
+      }
+
+      // Ping and close outside the lock.
+      //
+      close.clear ();
+
+      size_t pinged (check.size ());
+
+      for (connections::iterator i (check.begin ()); i != check.end ();)
+      {
+        bool alive;
+
+        try
+        {
+          alive = (*i)->ping ();
+        }
+        catch (const odb::exception&)
+        {
+          alive = false;
+        }
+
+        if (alive)
+        {
+          (*i)->checked_ = time (0);
+          ++i;
+        }
+        else
+          i = check.erase (i);
+      }
+
+      lock l (mutex_);
+      in_use_ -= pinged;
+
+      for (connections::iterator i (check.begin ()); i != check.end (); ++i)
+        connections_.push_back (*i);
+
+      // Wake up the waiters for the returned connections as well as for
+      // the slots freed by the dead ones.
+      //
+      for (size_t i (0); waiters_ != 0 && i != pinged; ++i)
+        cond_.signal ();
+    }
+
+    bool connection_pool_factory::
+    start_maintenance ()
+    {
+#ifndef ODB_THREADS_NONE
+      if (maintenance_interval_ == 0)
+        return false;
+
+      thread_.reset (new details::thread (&maintenance_thread, this));
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    void connection_pool_factory::
+    stop_maintenance ()
+    {
+#ifndef ODB_THREADS_NONE
+      if (thread_.get () != 0)
+      {
+        {
+          lock l (mutex_);
+          stop_ = true;
+        }
+
+        thread_->join ();
+        thread_.reset ();
+      }
+#endif
+    }
+
+    bool connection_pool_factory::
+    stopped ()
+    {
+      lock l (mutex_);
+      return stop_;
+    }
+
+    void* connection_pool_factory::
+    maintenance_thread (void* arg)
+    {
+#ifndef ODB_THREADS_NONE
+      connection_pool_factory& f (
+        *static_cast<connection_pool_factory*> (arg));
+
+      tls_get (mysql_thread_init_);
+
+      while (true)
+      {
+        try
+        {
+          f.maintain ();
+        }
+        catch (const std::exception&)
+        {
+          // Try again on the next pass (e.g., the server is down).
+        }
+
+        // Sleep in small steps so that we can be stopped promptly.
+        //
+        for (size_t i (0), n (f.maintenance_interval_ * 10); i != n; ++i)
+        {
+          if (f.stopped ())
+            return 0;
+
+          sleep_ms (100);
+        }
+      }
+#else
+      (void) arg;
+#endif
+      return 0;
+    }
+
+    // sharded_connection_pool_factory
+    //
+    sharded_connection_pool_factory::
+    sharded_connection_pool_factory (size_t max_connections,
+                                     size_t min_connections,
+                                     bool ping,
+                                     size_t shards)
+        : connection_pool_factory (max_connections, min_connections, ping),
+          shard_count_ (shards != 0 ? shards : 1),
+          shards_ (0)
+    {
+      if (max_ != 0 && shard_count_ > max_)
+        shard_count_ = max_;
+
+      shards_ = new shard[shard_count_];
+
+      // Divide the limits between the shards.
+      //
+      size_t n (shard_count_);
+      for (size_t i (0); i < n; ++i)
+      {
+        shard& s (shards_[i]);
+        s.max = max_ != 0 ? max_ / n + (i < max_ % n ? 1 : 0) : 0;
+        s.min = min_ / n + (i < min_ % n ? 1 : 0);
+      }
+    }
+
+    sharded_connection_pool_factory::
+    ~sharded_connection_pool_factory ()
+    {
+      stop_maintenance ();
+
+      // Wait for all the connections currently in use to return to
+      // the pool.
+      //
+      for (size_t i (0); i < shard_count_; ++i)
+      {
+        shard& s (shards_[i]);
+
+        lock l (s.mutex);
+        while (s.in_use != 0)
+          s.cond.wait (l);
+      }
+
+      delete[] shards_;
+    }
+
+    size_t sharded_connection_pool_factory::
+    home () const
+    {
+      // Use the address of the thread-specific MySQL initialization
+      // object to spread the threads over the shards.
+      //
+      size_t a (reinterpret_cast<size_t> (&tls_get (mysql_thread_init_)));
+      a ^= a >> 16;
+      return (a >> 4) % shard_count_;
+    }
+
+    connection_pool_factory::pooled_connection_ptr
+    sharded_connection_pool_factory::
+    acquire (size_t h, bool& created)
+    {
+      shard& s (shards_[h]);
+
+      {
+        lock l (s.mutex);
+
+        // See if we have a spare connection.
+        //
+        if (s.idle.size () != 0)
+        {
+          pooled_connection_ptr c (s.idle.back ());
+          s.idle.pop_back ();
+
+          c->callback_ = &c->cb_;
+          s.in_use++;
+          return c;
+        }
+
+        // See if we can create a new one. Reserve the slot so that we
+        // don't have to hold the lock while connecting.
+        //
+        if (s.max == 0 || s.in_use < s.max)
+        {
+          s.in_use++;
+          created = true;
+        }
+      }
+
+      if (created)
+      {
+        pooled_connection_ptr c;
+
+        try
+        {
+          c = create ();
+        }
+        catch (...)
+        {
+          lock l (s.mutex);
+
+          if (--s.in_use == 0)
+            s.cond.signal ();
+
+          // Let the next waiter try instead.
+          //
+          wake (s);
+          throw;
+        }
+
+        c->shard_ = h;
+        c->callback_ = &c->cb_;
+        return c;
+      }
+
+      return borrow (h);
+    }
+
+    connection_pool_factory::pooled_connection_ptr
+    sharded_connection_pool_factory::
+    borrow (size_t h)
+    {
+      // The connection is returned to its own shard on release.
+      //
+      for (size_t i (1); i < shard_count_; ++i)
+      {
+        shard& o (shards_[(h + i) % shard_count_]);
+
+        lock l (o.mutex);
+
+        if (o.idle.size () != 0)
+        {
+          pooled_connection_ptr c (o.idle.back ());
+          o.idle.pop_back ();
+
+          c->callback_ = &c->cb_;
+          o.in_use++;
+          return c;
+        }
+      }
+
+      return pooled_connection_ptr ();
+    }
+
+    connection_ptr sharded_connection_pool_factory::
+    connect (size_t timeout)
+    {
+      tls_get (mysql_thread_init_);
+
+      size_t h (home ());
+      shard& s (shards_[h]);
+
+      unsigned long long start (now_ms ());
+      bool waited (false);
+
+      // The outer loop checks whether the connection we were
+      // given is still valid.
+      //
+      while (true)
+      {
+        pooled_connection_ptr c;
+        bool created (false);
+
+        // The inner loop tries to find a free connection.
+        //
+        while (true)
+        {
+          c = acquire (h, created);
+
+          if (c != 0)
+          {
+            lock l (s.mutex);
+
+            if (created)
+              s.counters.creations++;
+
+            break;
+          }
+
+          // Wait until someone releases a connection into our shard.
+          // Re-check the state under the lock since a connection could
+          // have been released after acquire() has looked.
+          //
+          lock l (s.mutex);
+
+          if (s.idle.size () != 0 || s.max == 0 || s.in_use < s.max)
+            continue;
+
+          waited = true;
+
+          waiter w (s.mutex, start);
+          s.waiters.push_back (&w);
+
+          // A connection that becomes idle in another shard is handed
+          // over to the longest waiting thread (see hand_over()). But one
+          // that became idle after acquire() has looked and before we
+          // were queued could have been missed, so look again.
+          //
+          if (shard_count_ > 1)
+          {
+            s.mutex.unlock ();
+            pooled_connection_ptr b (borrow (h));
+            s.mutex.lock ();
+
+            if (b != 0)
+            {
+              // Unless we have been handed a connection in the meantime,
+              // use the borrowed one.
+              //
+              if (w.connection == 0)
+              {
+                if (!w.woken)
+                  s.waiters.erase (
+                    find (s.waiters.begin (), s.waiters.end (), &w));
+
+                c = b;
+                break;
+              }
+
+              s.mutex.unlock ();
+              give_back (b);
+              s.mutex.lock ();
+            }
+          }
+
+          if (timeout == 0)
+          {
+            while (!w.woken)
+              w.cond.wait (l);
+          }
+          else
+          {
+            // There is no timed wait on the condition so we poll.
+            //
+            while (!w.woken)
+            {
+              unsigned long long t (now_ms () - start);
+
+              if (t >= timeout)
+              {
+                s.waiters.erase (
+                  find (s.waiters.begin (), s.waiters.end (), &w));
+                s.counters.timeouts++;
+                throw connection_timeout ();
+              }
+
+              unsigned int d (static_cast<unsigned int> (timeout - t));
+
+              s.mutex.unlock ();
+              sleep_ms (d < 10 ? d : 10);
+              s.mutex.lock ();
+            }
+          }
+
+          // If we were woken up without a connection, then a failed
+          // connection was released and we can try to create a new one.
+          //
+          if (w.connection != 0)
+          {
+            c = w.connection;
+            break;
+          }
+        }
+
+        // For new connections we don't need to ping. Only count the
+        // checkout once the connection has passed the ping. Otherwise it
+        // is dropped and we try again.
+        //
+        if (created || !need_ping (*c) || c->ping ())
+        {
+          lock l (s.mutex);
+          s.counters.record (now_ms () - start, waited);
+          return c;
+        }
+      }
+
+      return pooled_connection_ptr (); // Never reached.
+    }
+
+    connection_pool_factory::statistics sharded_connection_pool_factory::
+    stats ()
+    {
+      statistics r;
+
+      for (size_t i (0); i < shard_count_; ++i)
+      {
+        shard& s (shards_[i]);
+
+        lock l (s.mutex);
+
+        statistics x (s.counters);
+        x.in_use = s.in_use;
+        x.idle = s.idle.size ();
+        x.waiters = s.waiters.size ();
+        r += x;
+      }
+
+      return r;
+    }
+
+    void sharded_connection_pool_factory::
+    database (database_type& db)
+    {
+      tls_get (mysql_thread_init_);
+
+      bool first (db_ == 0);
+
+      connection_factory::database (db);
+
+      if (!first)
+        return;
+
+      // If we have the maintenance thread, then it will open the initial
+      // connections.
+      //
+      if (start_maintenance ())
+        return;
+
+      for (size_t i (0); i < shard_count_; ++i)
+      {
+        shard& s (shards_[i]);
+        s.idle.reserve (s.min);
+
+        for (size_t j (0); j < s.min; ++j)
+        {
+          s.idle.push_back (create ());
+          s.idle.back ()->shard_ = i;
+        }
+
+        s.counters.creations += s.min;
+      }
+    }
+
+    bool sharded_connection_pool_factory::
+    release (pooled_connection* c)
+    {
+      c->clear ();
+      c->callback_ = 0;
+
+      shard& s (shards_[c->shard_]);
+
+      lock l (s.mutex);
+
+      if (s.waiters.size () != 0)
+      {
+        waiter* w (s.waiters.front ());
+        s.waiters.pop_front ();
+        w->woken = true;
+
+        if (!c->failed ())
+        {
+          // Hand the connection over to the first waiter. It stays in
+          // use.
+          //
+          c->released_ = c->checked_ = time (0);
+          c->recycle ();
+          c->callback_ = &c->cb_;
+          w->connection = pooled_connection_ptr (inc_ref (c));
+          w->cond.signal ();
+          return false;
+        }
+
+        w->cond.signal ();
+      }
+
+      // Determine if we need to keep or free this connection.
+      //
+      bool keep (!c->failed () &&
+                 (min_ == 0 || (s.idle.size () + s.in_use <= s.min)));
+
+      if (--s.in_use == 0)
+        s.cond.signal ();
+
+      if (keep)
+      {
+        c->released_ = c->checked_ = time (0);
+        s.idle.push_back (pooled_connection_ptr (inc_ref (c)));
+        s.idle.back ()->recycle ();
+      }
+
+      // Nobody is waiting in this shard but there may be waiters in the
+      // other shards.
+      //
+      l.unlock ();
+
+      if (keep && shard_count_ > 1)
+        hand_over (c->shard_);
+
+      return !keep;
+    }
+
+    void sharded_connection_pool_factory::
+    put (shard& s, const pooled_connection_ptr& c)
+    {
+      if (s.waiters.size () != 0)
+      {
+        waiter* w (s.waiters.front ());
+        s.waiters.pop_front ();
+
+        c->callback_ = &c->cb_;
+        s.in_use++;
+
+        w->connection = c;
+        w->woken = true;
+        w->cond.signal ();
+      }
+      else
+        s.idle.push_back (c);
+    }
+
+    void sharded_connection_pool_factory::
+    wake (shard& s)
+    {
+      if (s.waiters.size () != 0)
+      {
+        waiter* w (s.waiters.front ());
+        s.waiters.pop_front ();
+        w->woken = true;
+        w->cond.signal ();
+      }
+    }
+
+    bool sharded_connection_pool_factory::
+    hand_over (size_t h)
+    {
+      // Find the shard with the longest waiting thread. We only lock
+      // one shard at a time so the waiter may be gone by the time we
+      // get back to it.
+      //
+      size_t t (h);
+      unsigned long long since (0);
+
+      for (size_t i (1); i < shard_count_; ++i)
+      {
+        size_t j ((h + i) % shard_count_);
+        shard& o (shards_[j]);
+
+        lock l (o.mutex);
+
+        if (o.waiters.size () != 0 &&
+            (t == h || o.waiters.front ()->since < since))
+        {
+          t = j;
+          since = o.waiters.front ()->since;
+        }
+      }
+
+      if (t == h)
+        return false;
+
+      // Take an idle connection from our shard. It may not be the one
+      // that has just been released or there may be none left if it
+      // was taken by someone else.
+      //
+      shard& s (shards_[h]);
+      pooled_connection_ptr c;
+
+      {
+        lock l (s.mutex);
+
+        if (s.idle.size () == 0)
+          return false;
+
+        c = s.idle.back ();
+        s.idle.pop_back ();
+        s.in_use++;
+      }
+
+      c->callback_ = &c->cb_;
+
+      {
+        shard& o (shards_[t]);
+        lock l (o.mutex);
+
+        if (o.waiters.size () != 0)
+        {
+          waiter* w (o.waiters.front ());
+          o.waiters.pop_front ();
+
+          w->connection = c;
+          w->woken = true;
+          w->cond.signal ();
+          return true;
+        }
+      }
+
+      give_back (c);
+      return false;
+    }
+
+    void sharded_connection_pool_factory::
+    give_back (const pooled_connection_ptr& c)
+    {
+      shard& s (shards_[c->shard_]);
+      c->callback_ = 0;
+
+      lock l (s.mutex);
+
+      if (--s.in_use == 0)
+        s.cond.signal ();
+
+      put (s, c);
+    }
+
+    void sharded_connection_pool_factory::
+    maintain ()
+    {
+      bool ping (ping_ && ping_window_ != 0);
+
+      for (size_t i (0); i < shard_count_ && !stopped (); ++i)
+      {
+        shard& s (shards_[i]);
+
+        // Re-open connections up to this shard's share of
+        // min_connections.
+        //
+        while (!stopped ())
+        {
+          {
+            lock l (s.mutex);
+
+            if (s.idle.size () + s.in_use >= s.min)
+              break;
+
+            s.in_use++; // Reserve the slot.
+          }
+
+          pooled_connection_ptr c;
+
+          try
+          {
+            c = create ();
+          }
+          catch (...)
+          {
+            lock l (s.mutex);
+
+            if (--s.in_use == 0)
+              s.cond.signal ();
+
+            wake (s);
+            throw;
+          }
+
+          c->shard_ = i;
+          c->released_ = c->checked_ = time (0);
+
+          {
+            lock l (s.mutex);
+            s.in_use--;
+            s.counters.creations++;
+            put (s, c);
+          }
+
+          if (shard_count_ > 1)
+            hand_over (i);
+        }
+
+        if (idle_timeout_ == 0 && !ping)
+          continue;
+
+        // Sort out the idle connections that have been idle for too long
+        // and the ones that need to be pinged. The latter are counted as
+        // in use while we ping them.
+        //
+        time_t now (time (0));
+        connections close, check;
+
+        {
+          lock l (s.mutex);
+
+          connections keep;
+          size_t total (s.idle.size () + s.in_use);
+
+          for (connections::iterator j (s.idle.begin ());
+               j != s.idle.end (); ++j)
+          {
+            pooled_connection& c (**j);
+
+            if (idle_timeout_ != 0 &&
+                total > s.min &&
+                difftime (now, c.released_) >=
+                static_cast<double> (idle_timeout_))
+            {
+              close.push_back (*j);
+              total--;
+            }
+            else if (ping &&
+                     difftime (now, c.checked_) >=
+                     static_cast<double> (ping_window_))
+              check.push_back (*j);
+            else
+              keep.push_back (*j);
+          }
+
+          s.idle.swap (keep);
+          s.in_use += check.size ();
+        }
+
+        // Ping and close outside the lock.
+        //
+        close.clear ();
+
+        size_t pinged (check.size ());
+
+        for (connections::iterator j (check.begin ()); j != check.end ();)
+        {
+          bool alive;
+
+          try
+          {
+            alive = (*j)->ping ();
+          }
+          catch (const odb::exception&)
+          {
+            alive = false;
+          }
+
+          if (alive)
+          {
+            (*j)->checked_ = time (0);
+            ++j;
+          }
+          else
+            j = check.erase (j);
+        }
+
+        lock l (s.mutex);
+        s.in_use -= pinged;
+
+        for (connections::iterator j (check.begin ()); j != check.end (); ++j)
+          put (s, *j);
+
+        // Let the waiters create connections in place of the dead ones.
+        //
+        for (size_t n (pinged - check.size ()); n != 0; --n)
+          wake (s);
+
+        if (s.in_use == 0)
+          s.cond.signal ();
+
+        l.unlock ();
+
+        if (shard_count_ > 1)
+        {
+          for (size_t n (check.size ()); n != 0 && hand_over (i); --n) ;
+        }
+      }
+    }
+
+    //
+    // connection_pool_factory::statistics
+    //
+
+    connection_pool_factory::statistics::
+    statistics ()
+        : in_use (0),
+          idle (0),
+          waiters (0),
+          checkouts (0),
+          waits (0),
+          timeouts (0),
+          creations (0),
+          wait_time (0)
+    {
+      for (size_t i (0); i != histogram_size; ++i)
+        histogram[i] = 0;
+    }
+
+    void connection_pool_factory::statistics::
+    record (unsigned long long ms, bool waited)
+    {
+      checkouts++;
+      wait_time += ms;
+
+      if (waited)
+        waits++;
+
+      // Find the first bucket whose upper bound (2^i ms) is greater
+      // than the time.
+      //
+      size_t i (0);
+      for (unsigned long long b (1); ms >= b && i != histogram_size - 1;)
+      {
+        b <<= 1;
+        i++;
+      }
+
+      histogram[i]++;
+    }
+
+    connection_pool_factory::statistics& connection_pool_factory::statistics::
+    operator+= (const statistics& x)
+    {
+      in_use += x.in_use;
+      idle += x.idle;
+      waiters += x.waiters;
+      checkouts += x.checkouts;
+      waits += x.waits;
+      timeouts += x.timeouts;
+      creations += x.creations;
+      wait_time += x.wait_time;
+
+      for (size_t i (0); i != histogram_size; ++i)
+        histogram[i] += x.histogram[i];
+
+      return *this;
+    }
+
     //
     // connection_pool_factory::pooled_connection
     //
 
     connection_pool_factory::pooled_connection::
     pooled_connection (connection_pool_factory& f)
-        : connection (f)
+        : connection (f),
+          shard_ (0),
+          released_ (time (0)),
+          checked_ (released_)
     {
       cb_.arg = this;
       cb_.zero_counter = &zero_counter;
@@ -284,7 +1315,10 @@ namespace odb
 
     connection_pool_factory::pooled_connection::
     pooled_connection (connection_pool_factory& f, MYSQL* handle)
-        : connection (f, handle)
+        : connection (f, handle),
+          shard_ (0),
+          released_ (time (0)),
+          checked_ (released_)
     {
       cb_.arg = this;
       cb_.zero_counter = &zero_counter;
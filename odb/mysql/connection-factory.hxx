@@ -7,10 +7,14 @@
 
 #include <odb/pre.hxx>
 
+#include <deque>
 #include <vector>
+#include <ctime>   // std::time_t
 #include <cstddef> // std::size_t
 #include <cassert>
 
+#include <odb/details/config.hxx> // ODB_THREADS_NONE
+
 #include <odb/mysql/version.hxx>
 #include <odb/mysql/forward.hxx>
 #include <odb/mysql/connection.hxx>
@@ -18,6 +22,11 @@
 #include <odb/details/mutex.hxx>
 #include <odb/details/condition.hxx>
 #include <odb/details/shared-ptr.hxx>
+#include <odb/details/unique-ptr.hxx>
+
+#ifndef ODB_THREADS_NONE
+#  include <odb/details/thread.hxx>
+#endif
 
 #include <odb/mysql/details/export.hxx>
 
@@ -66,22 +75,124 @@ namespace odb
             ping_ (ping),
             in_use_ (0),
             waiters_ (0),
-            cond_ (mutex_)
+            cond_ (mutex_),
+            ping_window_ (0),
+            idle_timeout_ (0),
+            maintenance_interval_ (0),
+            stop_ (false),
+            connect_timeout_ (0)
       {
         // max_connections == 0 means unlimited.
         //
         assert (max_connections == 0 || max_connections >= min_connections);
       }
 
+      // Health management. These functions should be called before the
+      // factory is associated with the database.
+      //
+      // Skip the ping on checkout if the connection was known to be
+      // alive within the specified number of seconds. The default is 0
+      // (ping on every checkout if ping is true).
+      //
+      void
+      ping_window (std::size_t seconds)
+      {
+        ping_window_ = seconds;
+      }
+
+      // Close connections that have been idle for longer than the
+      // specified number of seconds while still maintaining
+      // min_connections. This is done by the maintenance thread. The
+      // default is 0 (never).
+      //
+      void
+      idle_timeout (std::size_t seconds)
+      {
+        idle_timeout_ = seconds;
+      }
+
+      // Start a background thread that opens the initial min_connections
+      // connections (instead of database() doing it serially) and then
+      // wakes up every specified number of seconds to ping the idle
+      // connections that are outside the ping window, close the ones
+      // that have exceeded the idle timeout, and re-open connections up
+      // to min_connections. The default is 0 (no maintenance thread).
+      // Ignored if the library was built without thread support.
+      //
+      void
+      maintenance_interval (std::size_t seconds)
+      {
+        maintenance_interval_ = seconds;
+      }
+
+      // Default checkout deadline in milliseconds used by connect(). If
+      // no connection becomes available within this time, then the
+      // connection_timeout exception is thrown. The default is 0 (wait
+      // indefinitely).
+      //
+      void
+      connect_timeout (std::size_t milliseconds)
+      {
+        connect_timeout_ = milliseconds;
+      }
+
       virtual connection_ptr
       connect ();
 
+      // Obtain a connection waiting at most the specified number of
+      // milliseconds (0 means wait indefinitely).
+      //
+      // Note that the thread abstraction used by the pool (details::
+      // condition) has no timed wait. As a result, a waiter with a
+      // timeout does not sleep on the condition but polls the pool every
+      // 10 milliseconds. It may therefore get a released connection up to
+      // 10 milliseconds late and, unlike a waiter without a timeout, it
+      // wakes up periodically while waiting.
+      //
+      virtual connection_ptr
+      connect (std::size_t timeout);
+
       virtual void
       database (database_type&);
 
       virtual
       ~connection_pool_factory ();
 
+      // Pool statistics.
+      //
+      struct LIBODB_MYSQL_EXPORT statistics
+      {
+        statistics ();
+
+        std::size_t in_use;  // Connections currently in use.
+        std::size_t idle;    // Idle connections.
+        std::size_t waiters; // Threads currently waiting for a connection.
+
+        unsigned long long checkouts;
+        unsigned long long waits;     // Checkouts that had to wait.
+        unsigned long long timeouts;  // Checkouts that timed out.
+        unsigned long long creations; // Connections opened.
+        unsigned long long wait_time; // Total checkout time, ms.
+
+        // Checkout time histogram. Element 0 counts checkouts that took
+        // less than 1ms, element i -- less than 2^i ms, and the last
+        // element -- the rest.
+        //
+        static const std::size_t histogram_size = 16;
+        unsigned long long histogram[histogram_size];
+
+        // Record a checkout.
+        //
+        void
+        record (unsigned long long milliseconds, bool waited);
+
+        statistics&
+        operator+= (const statistics&);
+      };
+
+      virtual statistics
+      stats ();
+
     private:
       connection_pool_factory (const connection_pool_factory&);
       connection_pool_factory& operator= (const connection_pool_factory&);
@@ -99,8 +210,17 @@ namespace odb
 
       private:
         friend class connection_pool_factory;
+        friend class sharded_connection_pool_factory;
 
         shared_base::refcount_callback cb_;
+
+        // Sub-pool this connection belongs to (see
+        // sharded_connection_pool_factory).
+        //
+        std::size_t shard_;
+
+        std::time_t released_; // Returned to the pool.
+        std::time_t checked_;  // Last known to be alive.
       };
 
       friend class pooled_connection;
@@ -117,9 +237,40 @@ namespace odb
     protected:
       // Return true if the connection should be deleted, false otherwise.
       //
-      bool
+      virtual bool
       release (pooled_connection*);
 
+      // Return true if the connection needs to be pinged before being
+      // returned to the caller.
+      //
+      bool
+      need_ping (const pooled_connection&) const;
+
+      // Perform a maintenance pass. Called periodically from the
+      // maintenance thread.
+      //
+      virtual void
+      maintain ();
+
+      // Start the maintenance thread if requested and supported. Return
+      // false if it was not started.
+      //
+      bool
+      start_maintenance ();
+
+      // Stop the maintenance thread, if any. Should be called by the
+      // destructor of a derived class that overrides maintain().
+      //
+      void
+      stop_maintenance ();
+
+      bool
+      stopped ();
+
+    private:
+      static void*
+      maintenance_thread (void*);
+
     protected:
       const std::size_t max_;
       const std::size_t min_;
@@ -132,6 +283,158 @@ namespace odb
 
       details::mutex mutex_;
       details::condition cond_;
+
+      std::size_t ping_window_;
+      std::size_t idle_timeout_;
+      std::size_t maintenance_interval_;
+
+      bool stop_; // Protected by mutex_.
+
+      std::size_t connect_timeout_;
+      statistics stats_; // Protected by mutex_.
+
+#ifndef ODB_THREADS_NONE
+      details::unique_ptr<details::thread> thread_;
+#endif
+    };
+
+    // Connection pool that is split into a number of independently-locked
+    // sub-pools (shards) in order to reduce contention with a large
+    // number of threads. Each thread is assigned a home shard which it
+    // uses to obtain and return connections. If the home shard has no
+    // idle connections and cannot create a new one, then idle connections
+    // are taken from other shards. Threads waiting for a connection are
+    // queued in their home shard and served in the FIFO order with a
+    // released connection handed directly to the first waiter. If there
+    // are no waiters in the shard, then a connection that becomes idle
+    // is handed over to the thread that has been waiting the longest in
+    // the other shards.
+    //
+    // The max_connections and min_connections limits are divided between
+    // the shards. The number of shards is reduced to max_connections if
+    // the latter is not 0 and is smaller. The ping argument has the same
+    // semantics as in connection_pool_factory.
+    //
+    class LIBODB_MYSQL_EXPORT sharded_connection_pool_factory:
+      public connection_pool_factory
+    {
+    public:
+      sharded_connection_pool_factory (std::size_t max_connections = 0,
+                                       std::size_t min_connections = 0,
+                                       bool ping = true,
+                                       std::size_t shards = 8);
+
+      using connection_pool_factory::connect;
+
+      // As in connection_pool_factory, a waiter with a timeout polls its
+      // shard every 10 milliseconds instead of waiting on the condition.
+      //
+      virtual connection_ptr
+      connect (std::size_t timeout);
+
+      virtual statistics
+      stats ();
+
+      virtual void
+      database (database_type&);
+
+      virtual
+      ~sharded_connection_pool_factory ();
+
+    private:
+      sharded_connection_pool_factory (
+        const sharded_connection_pool_factory&);
+      sharded_connection_pool_factory& operator= (
+        const sharded_connection_pool_factory&);
+
+    protected:
+      virtual bool
+      release (pooled_connection*);
+
+      virtual void
+      maintain ();
+
+    protected:
+      struct waiter
+      {
+        waiter (details::mutex& m, unsigned long long s)
+            : cond (m), since (s), woken (false) {}
+
+        details::condition cond;
+        unsigned long long since;         // Time the wait started.
+        pooled_connection_ptr connection; // Handed over by release().
+        bool woken;
+      };
+
+      struct shard
+      {
+        shard (): max (0), min (0), in_use (0), cond (mutex) {}
+
+        std::size_t max;
+        std::size_t min;
+        std::size_t in_use;
+
+        statistics counters;
+
+        connections idle;
+        std::deque<waiter*> waiters;
+
+        details::mutex mutex;
+        details::condition cond; // Signalled when in_use drops to 0.
+      };
+
+      // Return the home shard of the calling thread.
+      //
+      std::size_t
+      home () const;
+
+      // Obtain a connection from the specified shard or, if there are no
+      // idle connections in the home shard and no new connection can be
+      // created, from one of the other shards. Return NULL if all the
+      // shards are exhausted in which case the caller should wait. Set
+      // created to true if the connection is new.
+      //
+      pooled_connection_ptr
+      acquire (std::size_t home, bool& created);
+
+      // Take an idle connection from one of the shards other than the
+      // home one or return NULL if there are none. Should be called with
+      // no shards locked.
+      //
+      pooled_connection_ptr
+      borrow (std::size_t home);
+
+      // Return an idle connection to the shard, handing it over to the
+      // first waiter, if any. Should be called with the shard locked.
+      //
+      void
+      put (shard&, const pooled_connection_ptr&);
+
+      // Wake up the first waiter, if any, without a connection so that
+      // it can try to create one. Should be called with the shard locked.
+      //
+      void
+      wake (shard&);
+
+      // Hand an idle connection of the specified shard over to the thread
+      // that has been waiting the longest in the other shards, if any.
+      // Called after a connection has become idle in a shard without
+      // waiters. Return true if a connection was handed over. Should be
+      // called with no shards locked.
+      //
+      bool
+      hand_over (std::size_t shard);
+
+      // Return a connection obtained with acquire() from a shard other
+      // than the home one without using it. Should be called with no
+      // shards locked.
+      //
+      void
+      give_back (const pooled_connection_ptr&);
+
+    protected:
+      std::size_t shard_count_;
+      shard* shards_;
     };
   }
 }
@@ -4,6 +4,8 @@
 
 #include <new>    // std::bad_alloc
 #include <string>
+#include <cstring> // std::strlen
+#include <cassert>
 
 #include <odb/mysql/database.hxx>
 #include <odb/mysql/connection.hxx>
@@ -11,6 +13,7 @@
 #include <odb/mysql/statement.hxx>
 #include <odb/mysql/error.hxx>
 #include <odb/mysql/exceptions.hxx>
+#include <odb/mysql/handle-cache.hxx>
 #include <odb/mysql/statement-cache.hxx>
 
 using namespace std;
@@ -21,13 +24,36 @@ namespace odb
   {
     connection::
     connection (connection_factory& cf)
-        : odb::connection (cf), failed_ (false), active_ (0)
+        : odb::connection (cf),
+          failed_ (false),
+          active_ (0),
+          begin_ (0),
+          batch_ (0),
+          cursor_ (0),
+          fetch_block_ (0),
+          container_batch_ (false),
+          container_batch_size_ (0),
+          polymorphic_batch_ (0),
+          owners_ (0),
+          owners_generation_ (0)
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          , begun_ (false),
+          begun_statement_ (0)
+#endif
     {
       if (mysql_init (&mysql_) == 0)
         throw bad_alloc ();
 
       handle_.reset (&mysql_);
 
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      // Enable the non-blocking API. This does not affect the blocking
+      // calls.
+      //
+      if (mysql_options (handle_, MYSQL_OPT_NONBLOCK, 0) != 0)
+        throw bad_alloc ();
+#endif
+
       database_type& db (database ());
 
       if (*db.charset () != '\0')
@@ -63,6 +89,7 @@ namespace odb
 
       // Do this after we have established the connection.
       //
+      handle_cache_.reset (new handle_cache_type (*this));
       statement_cache_.reset (new statement_cache_type (*this));
     }
 
@@ -72,8 +99,32 @@ namespace odb
           failed_ (false),
           handle_ (handle),
           active_ (0),
+          begin_ (0),
+          batch_ (0),
+          cursor_ (0),
+          fetch_block_ (0),
+          container_batch_ (false),
+          container_batch_size_ (0),
+          polymorphic_batch_ (0),
+          owners_ (0),
+          owners_generation_ (0),
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          begun_ (false),
+          begun_statement_ (0),
+#endif
+          handle_cache_ (new handle_cache_type (*this)),
           statement_cache_ (new statement_cache_type (*this))
     {
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      // The handle has already been connected (with a blocking call) so
+      // here we can only enable the non-blocking API for the calls that
+      // follow, which is all it needs to be set for. To also connect
+      // without blocking, set MYSQL_OPT_NONBLOCK on the handle before
+      // connecting it.
+      //
+      if (mysql_options (handle_, MYSQL_OPT_NONBLOCK, 0) != 0)
+        throw bad_alloc ();
+#endif
     }
 
     connection::
@@ -90,12 +141,24 @@ namespace odb
         free_stmt_handles ();
     }
 
+    query_cache& connection::
+    query_cache ()
+    {
+      return database ().query_cache ();
+    }
+
     transaction_impl* connection::
     begin ()
     {
       return new transaction_impl (connection_ptr (inc_ref (this)));
     }
 
+    transaction_impl* connection::
+    begin (unsigned int mode)
+    {
+      return new transaction_impl (connection_ptr (inc_ref (this)), mode);
+    }
+
     unsigned long long connection::
     execute (const char* s, size_t n)
     {
@@ -161,12 +224,126 @@ namespace odb
       }
     }
 
+#ifdef LIBODB_MYSQL_NONBLOCKING
+    int connection::
+    begin_start (unsigned int mode)
+    {
+      assert (!begun_);
+
+      const char* s (transaction_impl::begin_statement (mode));
+      begun_statement_ = s;
+
+      {
+        odb::tracer* t;
+        if ((t = tracer ()) || (t = database ().tracer ()))
+          t->execute (*this, s);
+      }
+
+      int r (query_start (s, strlen (s)));
+
+      if (r == 0)
+        begun_ = true;
+
+      return r;
+    }
+
+    int connection::
+    begin_cont (int events)
+    {
+      int r (query_cont (events));
+
+      if (r == 0)
+        begun_ = true;
+
+      return r;
+    }
+
+    int connection::
+    clear_start ()
+    {
+      assert (active_ == 0);
+
+      if (begin_ == 0)
+        return 0;
+
+      const char* s (begin_);
+      begin_ = 0;
+
+      {
+        odb::tracer* t;
+        if ((t = transaction_tracer ()) ||
+            (t = tracer ()) ||
+            (t = database ().tracer ()))
+          t->execute (*this, s);
+      }
+
+      return query_start (s, strlen (s));
+    }
+
+    int connection::
+    clear_cont (int events)
+    {
+      return query_cont (events);
+    }
+
+    int connection::
+    query_start (const char* q, size_t n)
+    {
+      int e;
+      int r (mysql_real_query_start (
+               &e, handle_, q, static_cast<unsigned long> (n)));
+
+      if (r == 0 && e != 0)
+        translate_error (*this);
+
+      return r;
+    }
+
+    int connection::
+    query_cont (int events)
+    {
+      int e;
+      int r (mysql_real_query_cont (&e, handle_, events));
+
+      if (r == 0 && e != 0)
+        translate_error (*this);
+
+      return r;
+    }
+#endif
+
     void connection::
     clear_ ()
     {
       active_->cancel (); // Should clear itself from active_.
     }
 
+    void connection::
+    discard ()
+    {
+      if (active_ != 0)
+        active_->discard (); // Should clear itself from active_.
+    }
+
+    void connection::
+    begin_deferred ()
+    {
+      const char* s (begin_);
+      begin_ = 0;
+
+      {
+        odb::tracer* t;
+        if ((t = transaction_tracer ()) ||
+            (t = tracer ()) ||
+            (t = database ().tracer ()))
+          t->execute (*this, s);
+      }
+
+      if (mysql_real_query (
+            handle_, s, static_cast<unsigned long> (strlen (s))) != 0)
+        translate_error (*this);
+    }
+
     MYSQL_STMT* connection::
     alloc_stmt_handle ()
     {
@@ -202,6 +379,45 @@ namespace odb
       stmt_handles_.clear ();
     }
 
+    // batch_guard
+    //
+    batch_guard::
+    batch_guard (connection& c, size_t batch)
+        : c_ (&c), batch_ (c.batch ())
+    {
+      c.batch (batch);
+    }
+
+    batch_guard::
+    ~batch_guard ()
+    {
+      if (c_ != 0)
+      {
+        c_->batch (batch_);
+
+        // We are most likely unwinding because of an exception so the
+        // transaction is about to be rolled back.
+        //
+        try
+        {
+          c_->discard ();
+        }
+        catch (...)
+        {
+        }
+      }
+    }
+
+    void batch_guard::
+    flush ()
+    {
+      connection& c (*c_);
+      c_ = 0;
+
+      c.batch (batch_);
+      c.clear ();
+    }
+
     // connection_factory
     //
     connection_factory::
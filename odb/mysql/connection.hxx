@@ -8,6 +8,7 @@
 #include <odb/pre.hxx>
 
 #include <vector>
+#include <cstddef> // std::size_t
 
 #include <odb/connection.hxx>
 
@@ -28,17 +29,39 @@ namespace odb
 {
   namespace mysql
   {
+    class handle_cache;
     class statement_cache;
     class connection_factory;
 
+    // Objects in the current block of a query result whose containers
+    // and derived parts can be loaded with one statement each (see
+    // connection::container_batch() and polymorphic_batch()). The
+    // owners are identified by their positions in the block. Calling
+    // set_id() initializes the object id image and binding with the id
+    // of the specified owner.
+    //
+    struct owner_block
+    {
+      typedef void (*set_id_function) (void* context, std::size_t owner);
+
+      const binding* id;         // Object id binding.
+      std::size_t count;         // Number of owners in the block.
+      std::size_t current;       // Owner being loaded.
+      std::size_t generation;    // Assigned by the connection.
+      set_id_function set_id;
+      void* context;
+    };
+
     class connection;
     typedef details::shared_ptr<connection> connection_ptr;
 
     class LIBODB_MYSQL_EXPORT connection: public odb::connection
     {
     public:
+      typedef mysql::handle_cache handle_cache_type;
       typedef mysql::statement_cache statement_cache_type;
       typedef mysql::database database_type;
+      typedef mysql::query_cache query_cache_type;
 
       virtual
       ~connection ();
@@ -49,10 +72,21 @@ namespace odb
       database_type&
       database ();
 
+      // Translations of the dynamic queries shared by all the connections
+      // to the database (see query_cache for details).
+      //
+      query_cache_type&
+      query_cache ();
+
     public:
       virtual transaction_impl*
       begin ();
 
+      // Begin a transaction in the specified mode (see transaction_mode).
+      //
+      transaction_impl*
+      begin (unsigned int mode);
+
     public:
       using odb::connection::execute;
 
@@ -130,6 +164,15 @@ namespace odb
         return *statement_cache_;
       }
 
+      // Prepared SELECT statement handles available for reuse (see
+      // handle_cache for details).
+      //
+      handle_cache_type&
+      handle_cache ()
+      {
+        return *handle_cache_;
+      }
+
     public:
       statement*
       active ()
@@ -146,15 +189,239 @@ namespace odb
           free_stmt_handles ();
       }
 
-      // Cancel and clear the active statement, if any.
+      // Send the deferred BEGIN of a lazy transaction, if any, as well as
+      // cancel and clear the active statement, if any.
       //
       void
       clear ()
       {
+        if (begin_ != 0)
+          begin_deferred ();
+
         if (active_ != 0)
           clear_ ();
       }
 
+      // Discard instead of executing the work deferred by the active
+      // statement, if any (see statement::discard()), and clear it.
+      //
+      void
+      discard ();
+
+      // Statement batching. If the batch size is greater than 1, then
+      // rows of INSERT statements that don't return auto-assigned ids as
+      // well as of the object UPDATE and DELETE statements are accumulated
+      // and sent to the server as multi-row statements of up to this many
+      // rows. The pending rows are flushed when the batch is full or
+      // before any other statement is executed on this connection (see
+      // clear()) and discarded if the transaction is rolled back. Rows
+      // that turn out to be duplicates or not found when the batch is
+      // executed are reported with the batch_failed exception. The
+      // default is 0 (no batching).
+      //
+      // Note that only one batch can be pending on a connection at a
+      // time. In particular, when an object with containers is persisted
+      // or erased, the container statements flush the object batch and
+      // the next object statement flushes the container batch. Such
+      // objects are therefore sent one row per statement and only their
+      // container rows are batched (see container_batch_size()).
+      //
+    public:
+      std::size_t
+      batch () const
+      {
+        return batch_;
+      }
+
+      void
+      batch (std::size_t n)
+      {
+        batch_ = n;
+      }
+
+      // Server-side cursors. If the number of prefetch rows is not 0,
+      // then SELECT statements executed on this connection open a read-
+      // only cursor on the server and fetch rows from it in blocks of
+      // this many rows. Such a result does not need to be cancelled
+      // before other statements can be executed on the connection. The
+      // default is 0 (no cursors). See also database::query().
+      //
+    public:
+      std::size_t
+      cursor () const
+      {
+        return cursor_;
+      }
+
+      void
+      cursor (std::size_t prefetch_rows)
+      {
+        cursor_ = prefetch_rows;
+      }
+
+      // Block fetching. If the number of rows is greater than 1, then
+      // object query results created on this connection fetch rows in
+      // blocks of this many rows, each into its own image, and return
+      // objects from the current block. The default is 0 (fetch one
+      // row at a time into the object statements image).
+      //
+    public:
+      std::size_t
+      fetch_block () const
+      {
+        return fetch_block_;
+      }
+
+      void
+      fetch_block (std::size_t rows)
+      {
+        fetch_block_ = rows;
+      }
+
+      // Batch container loading. If enabled and the objects of a result
+      // are loaded in blocks (see fetch_block() above and
+      // polymorphic_batch() below), then the containers of all the
+      // objects in a block are loaded with one SELECT ... WHERE owner
+      // IN (...) statement per container once the first object in the
+      // block is loaded. The rows are then handed out to the objects as
+      // they are loaded. Only containers of objects with single-column
+      // ids are loaded this way. The default is false.
+      //
+    public:
+      bool
+      container_batch () const
+      {
+        return container_batch_;
+      }
+
+      void
+      container_batch (bool b)
+      {
+        container_batch_ = b;
+      }
+
+      // Container batch size. If greater than 1, then the rows inserted
+      // when a container is persisted or rewritten as well as the rows
+      // updated in a change-tracking container are sent to the server
+      // as multi-row statements of up to this many rows (see batch()
+      // for details). The default is 0 (use batch()).
+      //
+    public:
+      std::size_t
+      container_batch_size () const
+      {
+        return container_batch_size_;
+      }
+
+      void
+      container_batch_size (std::size_t rows)
+      {
+        container_batch_size_ = rows;
+      }
+
+      // Batch polymorphic loading. If greater than 1, then cached
+      // polymorphic object query results load the derived parts of the
+      // object being loaded and up to this many objects following it
+      // with one SELECT ... WHERE id IN (...) statement per dynamic type
+      // instead of one statement per object. Only hierarchies with
+      // single-column ids are loaded this way. The default is 0.
+      //
+    public:
+      std::size_t
+      polymorphic_batch () const
+      {
+        return polymorphic_batch_;
+      }
+
+      void
+      polymorphic_batch (std::size_t rows)
+      {
+        polymorphic_batch_ = rows;
+      }
+
+      // Owners of the rows that can currently be loaded in batch. Set by
+      // the object query results for the duration of each block.
+      //
+      owner_block*
+      owners () const
+      {
+        return owners_;
+      }
+
+      void
+      owners (owner_block* o)
+      {
+        if (o != 0)
+          o->generation = ++owners_generation_;
+
+        owners_ = o;
+      }
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      // Non-blocking execution (requires the MariaDB client library).
+      // The *_start() functions of the connection, statements, and
+      // transaction_impl return 0 if the operation has completed or a
+      // combination of the MYSQL_WAIT_* flags otherwise. In the latter
+      // case the caller should wait for these events on socket() (or
+      // for timeout() milliseconds if MYSQL_WAIT_TIMEOUT is set) and
+      // then call the corresponding *_cont() function with the events
+      // that occurred, until it returns 0. Only one operation can be in
+      // progress on a connection at any given time and no other calls
+      // should be made on the connection until it has completed. This
+      // allows a single thread to drive multiple connections.
+      //
+      // The work deferred by the active statement (pending batch rows
+      // or the unread rest of a result) cannot be completed without
+      // blocking. As a result, there should be no active statement when
+      // a non-blocking operation is started: flush the batches (for
+      // example, with batch_guard::flush()) and fetch the results to the
+      // end and free them first. This is checked with an assertion. The
+      // deferred BEGIN of a lazy transaction is sent without blocking.
+      //
+    public:
+      my_socket
+      socket () const
+      {
+        return mysql_get_socket (handle_);
+      }
+
+      unsigned int
+      timeout () const
+      {
+        return mysql_get_timeout_value_ms (handle_);
+      }
+
+      // Send the statement that starts a transaction in the specified
+      // mode (see transaction_mode). Once completed, the transaction
+      // returned by the following call to begin() is started without a
+      // round trip to the server. That call must specify the same mode,
+      // except for transaction_lazy, which has no effect since BEGIN has
+      // already been sent.
+      //
+      int
+      begin_start (unsigned int mode = 0);
+
+      int
+      begin_cont (int events);
+
+      // Non-blocking version of clear() that is called by the *_start()
+      // functions of the statements (see above for the limitations).
+      //
+      int
+      clear_start ();
+
+      int
+      clear_cont (int events);
+
+    private:
+      int
+      query_start (const char* q, std::size_t n);
+
+      int
+      query_cont (int events);
+
+#endif
+
     public:
       MYSQL_STMT*
       alloc_stmt_handle ();
@@ -173,8 +440,12 @@ namespace odb
       void
       clear_ ();
 
+      void
+      begin_deferred ();
+
     private:
-      friend class transaction_impl; // invalidate_results()
+      friend class transaction_impl; // invalidate_results(), query_*(),
+                                     // begin_
 
     private:
       bool failed_;
@@ -183,6 +454,27 @@ namespace odb
       auto_handle<MYSQL> handle_;
 
       statement* active_;
+      const char* begin_; // Deferred BEGIN statement of a lazy transaction.
+      std::size_t batch_;
+      std::size_t cursor_;
+      std::size_t fetch_block_;
+      bool container_batch_;
+      std::size_t container_batch_size_;
+      std::size_t polymorphic_batch_;
+      owner_block* owners_;
+      std::size_t owners_generation_;
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      bool begun_;
+      const char* begun_statement_; // Sent by begin_start().
+#endif
+
+      // Keep handle_cache_ after handle_ so that it is destroyed before
+      // the connection is closed. Keep it before statement_cache_ so that
+      // it is destroyed after the cached statements since they return
+      // their handles to it when destroyed.
+      //
+      details::unique_ptr<handle_cache_type> handle_cache_;
 
       // Keep statement_cache_ after handle_ so that it is destroyed before
       // the connection is closed.
@@ -196,6 +488,30 @@ namespace odb
       stmt_handles stmt_handles_;
     };
 
+    // Enable statement batching on the connection for the lifetime of the
+    // guard. Call flush() to execute the pending rows and restore the
+    // previous batch size. If the guard is destroyed without a call to
+    // flush() (e.g., because of an exception), then the pending rows
+    // are discarded without being sent to the server.
+    //
+    class LIBODB_MYSQL_EXPORT batch_guard
+    {
+    public:
+      batch_guard (connection&, std::size_t batch);
+      ~batch_guard ();
+
+      void
+      flush ();
+
+    private:
+      batch_guard (const batch_guard&);
+      batch_guard& operator= (const batch_guard&);
+
+    private:
+      connection* c_;
+      std::size_t batch_;
+    };
+
     class LIBODB_MYSQL_EXPORT connection_factory:
       public odb::connection_factory
     {
@@ -39,7 +39,7 @@ namespace odb
     {
       // Translate to native query.
       //
-      return prepare_query<T> (n, mysql::query_base (q));
+      return prepare_query<T> (n, mysql::query_base (q, query_cache ()));
     }
   }
 }
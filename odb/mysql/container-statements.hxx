@@ -131,6 +131,7 @@ namespace odb
               0,
               false));
 
+        insert_->batch_size (conn_.container_batch_size ());
         return *insert_;
       }
 
@@ -148,6 +149,25 @@ namespace odb
               select_image_binding_,
               false));
 
+        // Once batch container loading is used on the connection (see
+        // connection::container_batch()), the select statement consults
+        // the multi-owner statement on each execution.
+        //
+        if (bulk_select_ == 0 && conn_.owners () != 0 &&
+            conn_.container_batch ())
+        {
+          bulk_select_.reset (
+            new (details::shared) bulk_owner_select_statement (
+              conn_,
+              select_text_,
+              versioned_,
+              id_binding_,
+              select_image_binding_));
+
+          if (bulk_select_->valid ())
+            select_->batch (bulk_select_.get ());
+        }
+
         return *select_;
       }
 
@@ -191,6 +211,7 @@ namespace odb
       details::shared_ptr<insert_statement_type> insert_;
       details::shared_ptr<select_statement_type> select_;
       details::shared_ptr<delete_statement_type> delete_;
+      details::shared_ptr<bulk_owner_select_statement> bulk_select_;
     };
 
     template <typename T>
@@ -288,6 +309,7 @@ namespace odb
       update_statement ()
       {
         if (update_ == 0)
+        {
           update_.reset (
             new (details::shared) update_statement_type (
               this->conn_,
@@ -296,6 +318,13 @@ namespace odb
               update_image_binding_,
               false));
 
+          // The element is identified by the condition columns which
+          // come last in the update binding.
+          //
+          update_->batchable (traits::cond_column_count);
+        }
+
+        update_->batch_size (this->conn_.container_batch_size ());
         return *update_;
       }
 
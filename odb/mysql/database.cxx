@@ -49,7 +49,10 @@ namespace odb
           socket_ (socket ? socket_str_.c_str () : 0),
           charset_ (charset == 0 ? "" : charset),
           client_flags_ (client_flags),
-          factory_ (factory.transfer ())
+          factory_ (factory.transfer ()),
+          text_cache_ (new text_cache_type),
+          length_cache_ (new length_cache_type),
+          query_cache_ (new query_cache_type)
     {
       if (!factory_)
         factory_.reset (new connection_pool_factory ());
@@ -78,7 +81,10 @@ namespace odb
           socket_ (socket ? socket_str_.c_str () : 0),
           charset_ (charset),
           client_flags_ (client_flags),
-          factory_ (factory.transfer ())
+          factory_ (factory.transfer ()),
+          text_cache_ (new text_cache_type),
+          length_cache_ (new length_cache_type),
+          query_cache_ (new query_cache_type)
     {
       if (!factory_)
         factory_.reset (new connection_pool_factory ());
@@ -107,7 +113,10 @@ namespace odb
           socket_ (socket ? socket_str_.c_str () : 0),
           charset_ (charset),
           client_flags_ (client_flags),
-          factory_ (factory.transfer ())
+          factory_ (factory.transfer ()),
+          text_cache_ (new text_cache_type),
+          length_cache_ (new length_cache_type),
+          query_cache_ (new query_cache_type)
     {
       if (!factory_)
         factory_.reset (new connection_pool_factory ());
@@ -136,7 +145,10 @@ namespace odb
           socket_ (socket_str_.c_str ()),
           charset_ (charset),
           client_flags_ (client_flags),
-          factory_ (factory.transfer ())
+          factory_ (factory.transfer ()),
+          text_cache_ (new text_cache_type),
+          length_cache_ (new length_cache_type),
+          query_cache_ (new query_cache_type)
     {
       if (!factory_)
         factory_.reset (new connection_pool_factory ());
@@ -165,7 +177,10 @@ namespace odb
           socket_ (socket_str_.c_str ()),
           charset_ (charset),
           client_flags_ (client_flags),
-          factory_ (factory.transfer ())
+          factory_ (factory.transfer ()),
+          text_cache_ (new text_cache_type),
+          length_cache_ (new length_cache_type),
+          query_cache_ (new query_cache_type)
     {
       if (!factory_)
         factory_.reset (new connection_pool_factory ());
@@ -185,7 +200,10 @@ namespace odb
           socket_ (0),
           charset_ (charset),
           client_flags_ (client_flags),
-          factory_ (factory.transfer ())
+          factory_ (factory.transfer ()),
+          text_cache_ (new text_cache_type),
+          length_cache_ (new length_cache_type),
+          query_cache_ (new query_cache_type)
     {
       using namespace details;
 
@@ -237,6 +255,12 @@ namespace odb
       return new transaction_impl (*this);
     }
 
+    transaction_impl* database::
+    begin (unsigned int mode)
+    {
+      return new transaction_impl (*this, mode);
+    }
+
     odb::connection* database::
     connection_ ()
     {
@@ -8,7 +8,9 @@
 #include <odb/pre.hxx>
 
 #include <string>
-#include <iosfwd> // std::ostream
+#include <vector>
+#include <iosfwd>  // std::ostream
+#include <cstddef> // std::size_t
 
 #include <odb/database.hxx>
 #include <odb/details/config.hxx> // ODB_CXX11
@@ -22,6 +24,9 @@
 #include <odb/mysql/tracer.hxx>
 #include <odb/mysql/connection.hxx>
 #include <odb/mysql/connection-factory.hxx>
+#include <odb/mysql/text-cache.hxx>
+#include <odb/mysql/length-cache.hxx>
+#include <odb/mysql/query-cache.hxx>
 
 #include <odb/mysql/details/export.hxx>
 
@@ -31,6 +36,20 @@ namespace odb
   {
     class transaction_impl;
 
+    // Request a query result that is streamed from a server-side cursor
+    // in blocks of prefetch_rows rows (see connection::cursor()).
+    //
+    struct cursor
+    {
+      explicit
+      cursor (std::size_t prefetch_rows = 256)
+          : prefetch_rows (prefetch_rows)
+      {
+      }
+
+      std::size_t prefetch_rows;
+    };
+
     class LIBODB_MYSQL_EXPORT database: public odb::database
     {
     public:
@@ -212,6 +231,19 @@ namespace odb
       typename object_traits<T>::id_type
       persist (const typename object_traits<T>::pointer_type& obj_ptr);
 
+      // Make a range of objects persistent. The iterator value type can
+      // be an object or an object pointer. Objects that don't have auto-
+      // assigned ids are inserted using multi-row INSERT statements with
+      // up to batch rows each (see connection::batch()). Objects
+      // with auto-assigned ids are inserted one at a time. Note that a
+      // duplicate object is only detected when the batch containing it
+      // is executed so, unless it is the last object in the batch, it
+      // is reported with the batch_failed exception.
+      //
+      template <typename I>
+      void
+      persist (I begin, I end, std::size_t batch = 64);
+
       // Load an object. Throw object_not_persistent if not found.
       //
       template <typename T>
@@ -228,6 +260,17 @@ namespace odb
       void
       load (T& object, section&);
 
+      // Load (or reload) the specified section of each object in the
+      // [first, last) range. The iterator value type can be an object or
+      // an object pointer. The sections are loaded with multi-row SELECT
+      // statements (up to 64 objects per round trip) unless the object
+      // is polymorphic. As with find() above, the translation unit that
+      // calls this function must include the statements headers.
+      //
+      template <typename T, typename I>
+      void
+      load (I first, I last, section T::* s);
+
       // Reload an object.
       //
       template <typename T>
@@ -268,6 +311,24 @@ namespace odb
       bool
       find (const typename object_traits<T>::id_type& id, T& object);
 
+      // Load the objects with the ids in the [first, last) range and
+      // write their pointers to the output iterator in the same order,
+      // with NULL for the ids that are not found. Objects that are
+      // already in the session are not loaded again. The rest are
+      // loaded with multi-row SELECT statements (up to 64 objects per
+      // round trip) unless the object is polymorphic or versioned.
+      //
+      // Note that this function uses the object statements directly so
+      // the translation unit that calls it must include the statement
+      // cache and object statements headers:
+      //
+      // #include <odb/mysql/statement-cache.hxx>
+      // #include <odb/mysql/simple-object-statements.hxx>
+      //
+      template <typename T, typename I, typename O>
+      O
+      find (I first, I last, O out);
+
       // Update the state of a modified objects.
       //
       template <typename T>
@@ -306,6 +367,18 @@ namespace odb
       void
       update (const T& object, const section&);
 
+      // Update a range of objects. The iterator value type can be an
+      // object or an object pointer. Objects without optimistic
+      // concurrency are updated using multi-row UPDATE statements with
+      // up to batch rows each (see connection::batch()). Note that a
+      // missing object is only detected when the batch containing it is
+      // executed so it is reported with the batch_failed exception
+      // unless the batch contains just this object.
+      //
+      template <typename I>
+      void
+      update (I begin, I end, std::size_t batch = 64);
+
       // Make the object transient. Throw object_not_persistent if not
       // found.
       //
@@ -341,6 +414,24 @@ namespace odb
       void
       erase (const typename object_traits<T>::pointer_type& obj_ptr);
 
+      // Make a range of objects transient. The first version takes a
+      // range of object ids while in the second the iterator value type
+      // can be an object or an object pointer. The objects are deleted
+      // using multi-row DELETE statements with up to batch rows each (see
+      // connection::batch()). Note that the container rows of an object
+      // are deleted before the object itself, which flushes the pending
+      // rows. As a result, objects with containers end up deleted one
+      // row per statement. As with update(), a missing object is
+      // reported with the batch_failed exception.
+      //
+      template <typename T, typename I>
+      void
+      erase (I ids_begin, I ids_end, std::size_t batch = 64);
+
+      template <typename I>
+      void
+      erase (I begin, I end, std::size_t batch = 64);
+
       // Erase multiple objects matching a query predicate.
       //
       template <typename T>
@@ -385,6 +476,32 @@ namespace odb
       result<T>
       query (const odb::query_base&, bool cache = true);
 
+      // Query API with the result streamed from a server-side cursor.
+      // Such a result is never cached and its memory usage is bounded
+      // by the prefetch size. Other statements (for example, to load
+      // related objects) can be executed on the connection while the
+      // result is being iterated over.
+      //
+      template <typename T>
+      result<T>
+      query (const cursor&);
+
+      template <typename T>
+      result<T>
+      query (const char*, const cursor&);
+
+      template <typename T>
+      result<T>
+      query (const std::string&, const cursor&);
+
+      template <typename T>
+      result<T>
+      query (const mysql::query_base&, const cursor&);
+
+      template <typename T>
+      result<T>
+      query (const odb::query_base&, const cursor&);
+
       // Query one API.
       //
       template <typename T>
@@ -471,6 +588,13 @@ namespace odb
       virtual transaction_impl*
       begin ();
 
+      // Begin a transaction in the specified mode, for example:
+      //
+      // transaction t (db.begin (transaction_read_only | transaction_lazy));
+      //
+      transaction_impl*
+      begin (unsigned int mode);
+
     public:
       connection_ptr
       connection ();
@@ -500,6 +624,40 @@ namespace odb
       virtual const schema_version_info&
       load_schema_version (const std::string& schema_name) const;
 
+      // Processed statement text shared by all the connections (see
+      // text_cache for details).
+      //
+    public:
+      typedef mysql::text_cache text_cache_type;
+
+      text_cache_type&
+      text_cache ()
+      {
+        return *text_cache_;
+      }
+
+      // Result column lengths learned by all the connections (see
+      // length_cache for details).
+      //
+      typedef mysql::length_cache length_cache_type;
+
+      length_cache_type&
+      length_cache ()
+      {
+        return *length_cache_;
+      }
+
+      // Translations of the dynamic queries shared by all the connections
+      // (see query_cache for details).
+      //
+      typedef mysql::query_cache query_cache_type;
+
+      query_cache_type&
+      query_cache ()
+      {
+        return *query_cache_;
+      }
+
     public:
       // Database id constant (useful for meta-programming).
       //
@@ -513,6 +671,56 @@ namespace odb
       virtual odb::connection*
       connection_ ();
 
+    private:
+      template <typename T, typename I, typename O>
+      O
+      find_range_ (I, I, O, object_statements<T>*);
+
+      template <typename T, typename I, typename O>
+      O
+      find_range_ (I, I, O, polymorphic_root_object_statements<T>*);
+
+      template <typename T, typename I, typename O>
+      O
+      find_range_ (I, I, O, void*);
+
+      template <typename T, typename I>
+      void
+      load_range_ (I, I, section T::*, object_statements<T>*);
+
+      template <typename T, typename I>
+      void
+      load_range_ (I, I, section T::*,
+                   polymorphic_root_object_statements<T>*);
+
+      template <typename T, typename I>
+      void
+      load_range_ (I, I, section T::*, void*);
+
+      template <typename T>
+      static T&
+      object_ref_ (T& obj) {return obj;}
+
+      template <typename T>
+      static T&
+      object_ref_ (const typename object_traits<T>::pointer_type& p)
+      {
+        return odb::pointer_traits<
+          typename object_traits<T>::pointer_type>::get_ref (p);
+      }
+
+      // Owners of the sections being loaded by load_range_().
+      //
+      template <typename T>
+      struct section_owners: owner_block
+      {
+        std::vector<typename object_traits<T>::id_type> ids;
+        object_statements<T>* sts;
+
+        static void
+        init_id (void* context, std::size_t owner);
+      };
+
     private:
       // Note: remember to update move ctor if adding any new members.
       //
@@ -527,6 +735,9 @@ namespace odb
       std::string charset_;
       unsigned long client_flags_;
       details::unique_ptr<connection_factory> factory_;
+      details::unique_ptr<text_cache_type> text_cache_;
+      details::unique_ptr<length_cache_type> length_cache_;
+      details::unique_ptr<query_cache_type> query_cache_;
     };
   }
 }
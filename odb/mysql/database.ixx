@@ -2,7 +2,10 @@
 // copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
 // license   : GNU GPL v2; see accompanying LICENSE file
 
-#include <utility> // move()
+#include <deque>
+#include <vector>
+#include <utility>   // move()
+#include <algorithm> // std::find
 
 #include <odb/mysql/transaction.hxx>
 
@@ -24,7 +27,10 @@ namespace odb
           socket_ (db.socket_ != 0 ? socket_str_.c_str () : 0),
           charset_ (std::move (db.charset_)),
           client_flags_ (db.client_flags_),
-          factory_ (std::move (db.factory_))
+          factory_ (std::move (db.factory_)),
+          text_cache_ (std::move (db.text_cache_)),
+          length_cache_ (std::move (db.length_cache_)),
+          query_cache_ (std::move (db.query_cache_))
     {
       factory_->database (*this); // New database instance.
     }
@@ -122,6 +128,18 @@ namespace odb
       return persist_<T, id_mysql> (pobj);
     }
 
+    template <typename I>
+    inline void database::
+    persist (I b, I e, std::size_t batch)
+    {
+      batch_guard g (transaction::current ().connection (), batch);
+
+      for (; b != e; ++b)
+        persist (*b);
+
+      g.flush ();
+    }
+
     template <typename T>
     inline typename object_traits<T>::pointer_type database::
     load (const typename object_traits<T>::id_type& id)
@@ -157,6 +175,252 @@ namespace odb
       return find_<T, id_mysql> (id, obj);
     }
 
+    template <typename T, typename I, typename O>
+    inline O database::
+    find (I b, I e, O out)
+    {
+      typedef
+      typename object_traits_impl<T, id_mysql>::statements_type
+      statements_type;
+
+      return find_range_<T> (b, e, out, static_cast<statements_type*> (0));
+    }
+
+    template <typename T, typename I, typename O>
+    O database::
+    find_range_ (I b, I e, O out, object_statements<T>*)
+    {
+      typedef object_traits_impl<T, id_mysql> object_traits;
+      typedef typename object_traits::pointer_type pointer_type;
+      typedef odb::pointer_traits<pointer_type> pointer_traits;
+      typedef typename object_traits::pointer_cache_traits
+        pointer_cache_traits;
+
+      // We need the schema version migration to load versioned objects.
+      //
+      if (object_traits::versioned)
+        return find_range_<T> (b, e, out, static_cast<void*> (0));
+
+      // Only use the statements through dependent types. They are not
+      // included by this file (see the find() declaration).
+      //
+      typename object_statements<T>::connection_type& c (
+        transaction::current ().connection ());
+      object_statements<T>& sts (
+        c.statement_cache ().template find_object<T> ());
+
+      // If the statements are already locked (we are being called while
+      // loading an object of this type), then each find() call below
+      // will delay the load until the outer load completes.
+      //
+      typename object_statements<T>::auto_lock l (sts);
+
+      if (!l.locked ())
+        return find_range_<T> (b, e, out, static_cast<void*> (0));
+
+      // Create the objects that are not in the session and queue them
+      // for loading. The delayed loads are then processed in batches
+      // (see object_statements::load_delayed_()). Note that we use
+      // deque for the found flags since it doesn't move the elements.
+      //
+      std::vector<pointer_type> ps;
+      std::vector<bool> created;
+      std::deque<bool> found;
+
+      try
+      {
+        for (; b != e; ++b)
+        {
+          typename object_traits::id_type id (*b);
+          pointer_type p (pointer_cache_traits::find (*this, id));
+
+          found.push_back (true);
+
+          if (!pointer_traits::null_ptr (p))
+          {
+            ps.push_back (p);
+            created.push_back (false);
+            continue;
+          }
+
+          p = access::object_factory<T, pointer_type>::create ();
+          ps.push_back (p);
+          created.push_back (true);
+
+          typename pointer_cache_traits::insert_guard ig (
+            pointer_cache_traits::insert (*this, id, p));
+
+          sts.delay_load (id,
+                          pointer_traits::get_ref (p),
+                          ig.position (),
+                          0,
+                          &found.back ());
+          ig.release ();
+        }
+
+        sts.load_delayed (0);
+      }
+      catch (...)
+      {
+        for (std::size_t i (0); i != ps.size (); ++i)
+        {
+          if (created[i])
+          {
+            typename pointer_traits::guard g (ps[i]); // Free if raw.
+          }
+        }
+
+        throw;
+      }
+
+      l.unlock ();
+
+      // Free the objects that were not found, also clearing any other
+      // occurrences of the same id obtained from the session.
+      //
+      std::vector<const T*> missing;
+
+      for (std::size_t i (0); i != ps.size (); ++i)
+      {
+        if (created[i] && !found[i])
+        {
+          missing.push_back (&pointer_traits::get_ref (ps[i]));
+          typename pointer_traits::guard g (ps[i]);
+          ps[i] = pointer_type ();
+        }
+      }
+
+      for (std::size_t i (0); i != ps.size (); ++i)
+      {
+        if (!missing.empty () &&
+            !created[i] &&
+            std::find (missing.begin (),
+                       missing.end (),
+                       &pointer_traits::get_ref (ps[i])) != missing.end ())
+          ps[i] = pointer_type ();
+
+        *out++ = ps[i];
+      }
+
+      return out;
+    }
+
+    template <typename T, typename I, typename O>
+    inline O database::
+    find_range_ (I b, I e, O out, polymorphic_root_object_statements<T>*)
+    {
+      return find_range_<T> (b, e, out, static_cast<void*> (0));
+    }
+
+    template <typename T, typename I, typename O>
+    O database::
+    find_range_ (I b, I e, O out, void*)
+    {
+      for (; b != e; ++b)
+        *out++ = find<T> (*b);
+
+      return out;
+    }
+
+    template <typename T, typename I>
+    inline void database::
+    load (I b, I e, section T::* s)
+    {
+      typedef
+      typename object_traits_impl<T, id_mysql>::statements_type
+      statements_type;
+
+      load_range_<T> (b, e, s, static_cast<statements_type*> (0));
+    }
+
+    template <typename T, typename I>
+    void database::
+    load_range_ (I b, I e, section T::* s, object_statements<T>*)
+    {
+      typedef object_traits_impl<T, id_mysql> object_traits;
+
+      std::vector<T*> objs;
+      for (; b != e; ++b)
+        objs.push_back (&object_ref_<T> (*b));
+
+      if (objs.size () < 2)
+      {
+        if (!objs.empty ())
+          load (*objs[0], objs[0]->*s);
+
+        return;
+      }
+
+      typename object_statements<T>::connection_type& c (
+        transaction::current ().connection ());
+      object_statements<T>& sts (
+        c.statement_cache ().template find_object<T> ());
+
+      // Publish the object ids as the owners on the connection so that
+      // the section select statement loads the sections of up to 64
+      // objects with one statement (see bulk_owner_select_statement).
+      // Each section is then loaded, and its state updated, by the
+      // generated code as usual, only from the multi-object result.
+      //
+      section_owners<T> o;
+      o.sts = &sts;
+
+      for (std::size_t i (0); i != objs.size (); ++i)
+        o.ids.push_back (object_traits::id (*objs[i]));
+
+      o.id = &sts.id_image_binding ();
+      o.count = o.ids.size ();
+      o.current = ~std::size_t (0);
+      o.set_id = &section_owners<T>::init_id;
+      o.context = &o;
+
+      owner_block* p (c.owners ());
+      c.owners (&o);
+
+      try
+      {
+        for (std::size_t i (0); i != objs.size (); ++i)
+        {
+          o.current = i;
+          load (*objs[i], objs[i]->*s);
+        }
+      }
+      catch (...)
+      {
+        c.owners (p);
+        throw;
+      }
+
+      c.owners (p);
+    }
+
+    template <typename T, typename I>
+    void database::
+    load_range_ (I b, I e, section T::* s,
+                 polymorphic_root_object_statements<T>*)
+    {
+      load_range_<T> (b, e, s, static_cast<void*> (0));
+    }
+
+    template <typename T, typename I>
+    void database::
+    load_range_ (I b, I e, section T::* s, void*)
+    {
+      for (; b != e; ++b)
+      {
+        T& obj (object_ref_<T> (*b));
+        load (obj, obj.*s);
+      }
+    }
+
+    template <typename T>
+    void database::section_owners<T>::
+    init_id (void* context, std::size_t owner)
+    {
+      section_owners& o (*static_cast<section_owners*> (context));
+      o.sts->init_id (o.ids[owner]);
+    }
+
     template <typename T>
     inline void database::
     reload (T& obj)
@@ -290,6 +554,18 @@ namespace odb
       update_<T, id_mysql> (obj, s);
     }
 
+    template <typename I>
+    inline void database::
+    update (I b, I e, std::size_t batch)
+    {
+      batch_guard g (transaction::current ().connection (), batch);
+
+      for (; b != e; ++b)
+        update (*b);
+
+      g.flush ();
+    }
+
     template <typename T>
     inline void database::
     erase (const typename object_traits<T>::id_type& id)
@@ -372,6 +648,30 @@ namespace odb
       erase_<T, id_mysql> (pobj);
     }
 
+    template <typename T, typename I>
+    inline void database::
+    erase (I b, I e, std::size_t batch)
+    {
+      batch_guard g (transaction::current ().connection (), batch);
+
+      for (; b != e; ++b)
+        erase<T> (*b);
+
+      g.flush ();
+    }
+
+    template <typename I>
+    inline void database::
+    erase (I b, I e, std::size_t batch)
+    {
+      batch_guard g (transaction::current ().connection (), batch);
+
+      for (; b != e; ++b)
+        erase (*b);
+
+      g.flush ();
+    }
+
     template <typename T>
     inline unsigned long long database::
     erase_query ()
@@ -414,7 +714,7 @@ namespace odb
     {
       // Translate to native query.
       //
-      return erase_query<T> (mysql::query_base (q));
+      return erase_query<T> (mysql::query_base (q, query_cache ()));
     }
 
     template <typename T>
@@ -459,7 +759,59 @@ namespace odb
     {
       // Translate to native query.
       //
-      return query<T> (mysql::query_base (q), cache);
+      return query<T> (mysql::query_base (q, query_cache ()), cache);
+    }
+
+    template <typename T>
+    inline result<T> database::
+    query (const cursor& c)
+    {
+      return query<T> (mysql::query_base (), c);
+    }
+
+    template <typename T>
+    inline result<T> database::
+    query (const char* q, const cursor& c)
+    {
+      return query<T> (mysql::query_base (q), c);
+    }
+
+    template <typename T>
+    inline result<T> database::
+    query (const std::string& q, const cursor& c)
+    {
+      return query<T> (mysql::query_base (q), c);
+    }
+
+    template <typename T>
+    inline result<T> database::
+    query (const mysql::query_base& q, const cursor& c)
+    {
+      connection_type& conn (transaction::current ().connection ());
+
+      std::size_t p (conn.cursor ());
+      conn.cursor (c.prefetch_rows);
+
+      try
+      {
+        result<T> r (query_<T, id_mysql>::call (*this, q));
+        conn.cursor (p);
+        return r;
+      }
+      catch (...)
+      {
+        conn.cursor (p);
+        throw;
+      }
+    }
+
+    template <typename T>
+    inline result<T> database::
+    query (const odb::query_base& q, const cursor& c)
+    {
+      // Translate to native query.
+      //
+      return query<T> (mysql::query_base (q, query_cache ()), c);
     }
 
     template <typename T>
@@ -561,7 +913,7 @@ namespace odb
     {
       // Translate to native query.
       //
-      return query_one<T> (mysql::query_base (q));
+      return query_one<T> (mysql::query_base (q, query_cache ()));
     }
 
     template <typename T>
@@ -570,7 +922,7 @@ namespace odb
     {
       // Translate to native query.
       //
-      return query_one<T> (mysql::query_base (q), o);
+      return query_one<T> (mysql::query_base (q, query_cache ()), o);
     }
 
     template <typename T>
@@ -579,7 +931,7 @@ namespace odb
     {
       // Translate to native query.
       //
-      return query_value<T> (mysql::query_base (q));
+      return query_value<T> (mysql::query_base (q, query_cache ()));
     }
 
     template <typename T>
@@ -612,7 +964,7 @@ namespace odb
     {
       // Translate to native query.
       //
-      return prepare_query<T> (n, mysql::query_base (q));
+      return prepare_query<T> (n, mysql::query_base (q, query_cache ()));
     }
   }
 }
@@ -17,6 +17,14 @@
 #  include <odb/mysql/details/config.h>
 #endif
 
+#include <odb/details/config.hxx> // ODB_CXX11
+
+// C++11 <atomic>. Note that VC++ 10 is C++11-enabled but lacks it.
+//
+#if defined(ODB_CXX11) && (!defined(_MSC_VER) || _MSC_VER >= 1700)
+#  define LIBODB_MYSQL_CXX11_ATOMIC 1
+#endif
+
 // no post
 
 #endif // ODB_MYSQL_DETAILS_CONFIG_HXX
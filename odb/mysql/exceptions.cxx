@@ -68,5 +68,57 @@ namespace odb
     {
       return new cli_exception (*this);
     }
+
+    //
+    // connection_timeout
+    //
+
+    const char* connection_timeout::
+    what () const ODB_NOTHROW_NOEXCEPT
+    {
+      return "timeout waiting for a connection";
+    }
+
+    connection_timeout* connection_timeout::
+    clone () const
+    {
+      return new connection_timeout (*this);
+    }
+
+    //
+    // batch_failed
+    //
+
+    batch_failed::
+    batch_failed (statement_kind k, size_t f, size_t r)
+        : kind_ (k), failed_ (f), rows_ (r)
+    {
+      ostringstream ostr;
+      ostr << failed_ << " of " << rows_ << " batched rows ";
+
+      if (kind_ == statement_insert)
+        ostr << "were duplicates";
+      else
+        ostr << "were not found";
+
+      what_ = ostr.str ();
+    }
+
+    batch_failed::
+    ~batch_failed () ODB_NOTHROW_NOEXCEPT
+    {
+    }
+
+    const char* batch_failed::
+    what () const ODB_NOTHROW_NOEXCEPT
+    {
+      return what_.c_str ();
+    }
+
+    batch_failed* batch_failed::
+    clone () const
+    {
+      return new batch_failed (*this);
+    }
   }
 }
@@ -8,6 +8,7 @@
 #include <odb/pre.hxx>
 
 #include <string>
+#include <cstddef> // std::size_t
 
 #include <odb/exceptions.hxx>
 #include <odb/details/config.hxx> // ODB_NOTHROW_NOEXCEPT
@@ -75,10 +76,71 @@ namespace odb
       std::string what_;
     };
 
+    // Thrown by the connection pool if no connection became available
+    // within the checkout deadline.
+    //
+    struct LIBODB_MYSQL_EXPORT connection_timeout: odb::exception
+    {
+      virtual const char*
+      what () const ODB_NOTHROW_NOEXCEPT;
+
+      virtual connection_timeout*
+      clone () const;
+    };
+
+    // Thrown when a batch of deferred statement rows (see
+    // connection::batch()) is executed and some of the rows were
+    // duplicates (INSERT) or were not found (UPDATE and DELETE). Since
+    // such rows were added by earlier calls, the failure is reported
+    // for the batch as a whole rather than for the object that was
+    // being persisted, updated, or erased when the batch was executed.
+    //
+    struct LIBODB_MYSQL_EXPORT batch_failed: odb::exception
+    {
+      batch_failed (statement_kind, std::size_t failed, std::size_t rows);
+      ~batch_failed () ODB_NOTHROW_NOEXCEPT;
+
+      statement_kind
+      kind () const
+      {
+        return kind_;
+      }
+
+      // Number of rows that failed.
+      //
+      std::size_t
+      failed () const
+      {
+        return failed_;
+      }
+
+      // Number of rows in the batch.
+      //
+      std::size_t
+      rows () const
+      {
+        return rows_;
+      }
+
+      virtual const char*
+      what () const ODB_NOTHROW_NOEXCEPT;
+
+      virtual batch_failed*
+      clone () const;
+
+    private:
+      statement_kind kind_;
+      std::size_t failed_;
+      std::size_t rows_;
+      std::string what_;
+    };
+
     namespace core
     {
       using mysql::database_exception;
       using mysql::cli_exception;
+      using mysql::connection_timeout;
+      using mysql::batch_failed;
     }
   }
 }
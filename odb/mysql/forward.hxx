@@ -75,6 +75,7 @@ namespace odb
     class section_statements;
 
     class query_base;
+    class query_cache;
   }
 
   namespace details
@@ -0,0 +1,192 @@
+// file      : odb/mysql/handle-cache.cxx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#include <odb/mysql/database.hxx>
+#include <odb/mysql/connection.hxx>
+#include <odb/mysql/handle-cache.hxx>
+
+using namespace std;
+
+namespace odb
+{
+  namespace mysql
+  {
+    handle_cache::
+    handle_cache (connection_type& conn, size_t capacity)
+        : conn_ (conn),
+          capacity_ (capacity),
+          version_seq_ (conn.database ().schema_version_sequence ())
+    {
+    }
+
+    handle_cache::
+    ~handle_cache ()
+    {
+      try
+      {
+        clear ();
+      }
+      catch (...)
+      {
+      }
+    }
+
+    void handle_cache::
+    capacity (size_t n)
+    {
+      capacity_ = n;
+
+      while (map_.size () > capacity_)
+        evict ();
+    }
+
+    MYSQL_STMT* handle_cache::
+    take (const char* text, size_t text_size)
+    {
+      check_version ();
+
+      if (capacity_ == 0)
+        return 0;
+
+      map::iterator i (map_.find (string (text, text_size)));
+
+      if (i == map_.end ())
+      {
+        stats_.misses++;
+        return 0;
+      }
+
+      MYSQL_STMT* h (i->second.handle);
+      lru_.erase (i->second.pos);
+      map_.erase (i);
+
+      stats_.hits++;
+      return h;
+    }
+
+    void handle_cache::
+    put (const char* text, size_t text_size, auto_handle<MYSQL_STMT>& h)
+    {
+      try
+      {
+        check_version ();
+
+        if (capacity_ == 0)
+        {
+          conn_.free_stmt_handle (h);
+          return;
+        }
+
+        entry e;
+        e.handle = h;
+
+        pair<map::iterator, bool> r (
+          map_.insert (map::value_type (string (text, text_size), e)));
+
+        // If there is already a handle for this text (the same query was
+        // executed while another was still in use), keep the cached one.
+        //
+        if (!r.second)
+        {
+          conn_.free_stmt_handle (h);
+          return;
+        }
+
+        try
+        {
+          lru_.push_front (r.first);
+        }
+        catch (...)
+        {
+          map_.erase (r.first);
+          throw;
+        }
+
+        r.first->second.pos = lru_.begin ();
+        h.release ();
+
+        if (map_.size () > capacity_)
+          evict ();
+      }
+      catch (...)
+      {
+        // The only thing that can throw here is memory allocation. If we
+        // still own the handle, then close it now instead of letting the
+        // exception escape the statement destructor.
+        //
+        if (h != 0)
+        {
+          // Closing a handle while another statement is active would
+          // interfere with its unread result (which is why the connection
+          // normally delays it). So clear the active statement first. If
+          // that fails as well, then the connection cannot be trusted
+          // anymore and we mark it as failed so that it is not reused.
+          //
+          if (conn_.active () != 0)
+          {
+            try
+            {
+              conn_.clear ();
+            }
+            catch (...)
+            {
+              conn_.mark_failed ();
+            }
+          }
+
+          h.reset ();
+        }
+      }
+    }
+
+    void handle_cache::
+    clear ()
+    {
+      while (!map_.empty ())
+      {
+        map::iterator i (lru_.back ());
+        MYSQL_STMT* h (i->second.handle);
+
+        lru_.pop_back ();
+        map_.erase (i);
+        free (h);
+      }
+    }
+
+    void handle_cache::
+    check_version ()
+    {
+      unsigned int v (conn_.database ().schema_version_sequence ());
+
+      if (version_seq_ != v)
+      {
+        clear ();
+        version_seq_ = v;
+      }
+    }
+
+    void handle_cache::
+    evict ()
+    {
+      map::iterator i (lru_.back ());
+      MYSQL_STMT* h (i->second.handle);
+
+      lru_.pop_back ();
+      map_.erase (i);
+
+      stats_.evictions++;
+      free (h);
+    }
+
+    void handle_cache::
+    free (MYSQL_STMT* p)
+    {
+      // Let the connection close the handle since it may have to delay
+      // this if there is an active statement.
+      //
+      auto_handle<MYSQL_STMT> h (p);
+      conn_.free_stmt_handle (h);
+    }
+  }
+}
@@ -0,0 +1,138 @@
+// file      : odb/mysql/handle-cache.hxx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#ifndef ODB_MYSQL_HANDLE_CACHE_HXX
+#define ODB_MYSQL_HANDLE_CACHE_HXX
+
+#include <odb/pre.hxx>
+
+#include <map>
+#include <list>
+#include <string>
+#include <cstddef> // std::size_t
+
+#include <odb/mysql/mysql.hxx>
+#include <odb/mysql/version.hxx>
+#include <odb/mysql/forward.hxx>
+#include <odb/mysql/auto-handle.hxx>
+
+#include <odb/mysql/details/export.hxx>
+
+namespace odb
+{
+  namespace mysql
+  {
+    // Cache of prepared SELECT statement handles keyed by the final
+    // statement text. It allows the statements that are prepared anew
+    // for each query execution (for example, by database::query()) to
+    // reuse the handle prepared for the same text earlier instead of
+    // preparing it again. The cache is bounded and when it is full
+    // the least recently used handle is closed. The cache is cleared
+    // if the database schema version changes.
+    //
+    class LIBODB_MYSQL_EXPORT handle_cache
+    {
+    public:
+      typedef mysql::connection connection_type;
+
+      handle_cache (connection_type&, std::size_t capacity = 64);
+
+      ~handle_cache ();
+
+      // Maximum number of cached handles. 0 disables caching.
+      //
+      std::size_t
+      capacity () const
+      {
+        return capacity_;
+      }
+
+      void
+      capacity (std::size_t);
+
+      std::size_t
+      size () const
+      {
+        return map_.size ();
+      }
+
+      // Remove the handle prepared for this text from the cache and
+      // return it or return 0 if there is no such handle.
+      //
+      MYSQL_STMT*
+      take (const char* text, std::size_t text_size);
+
+      // Take over the handle prepared for this text. Any result on the
+      // handle should have been freed. This function does not throw
+      // since it is called from the statement destructor. If the handle
+      // cannot be cached or its release delayed (out of memory), then
+      // the active statement, if any, is cleared and the handle is
+      // closed immediately. If clearing fails, then the connection is
+      // marked as failed.
+      //
+      void
+      put (const char* text,
+           std::size_t text_size,
+           auto_handle<MYSQL_STMT>&);
+
+      void
+      clear ();
+
+      struct statistics
+      {
+        statistics (): hits (0), misses (0), evictions (0) {}
+
+        std::size_t hits;
+        std::size_t misses;
+        std::size_t evictions;
+      };
+
+      const statistics&
+      stats () const
+      {
+        return stats_;
+      }
+
+    private:
+      handle_cache (const handle_cache&);
+      handle_cache& operator= (const handle_cache&);
+
+    private:
+      // Clear the cache if the database schema version has changed.
+      //
+      void
+      check_version ();
+
+      void
+      evict ();
+
+      void
+      free (MYSQL_STMT*);
+
+    private:
+      struct entry;
+      typedef std::map<std::string, entry> map;
+      typedef std::list<map::iterator> lru; // Most recently used first.
+
+      struct entry
+      {
+        MYSQL_STMT* handle;
+        lru::iterator pos;
+      };
+
+      connection_type& conn_;
+      std::size_t capacity_;
+      unsigned int version_seq_;
+
+      map map_;
+      lru lru_;
+
+      statistics stats_;
+    };
+  }
+}
+
+#include <odb/post.hxx>
+
+#endif // ODB_MYSQL_HANDLE_CACHE_HXX
@@ -0,0 +1,106 @@
+// file      : odb/mysql/length-cache.cxx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#include <odb/details/lock.hxx>
+
+#include <odb/mysql/mysql.hxx>
+#include <odb/mysql/binding.hxx>
+#include <odb/mysql/length-cache.hxx>
+
+using namespace std;
+
+namespace odb
+{
+  namespace mysql
+  {
+    using namespace details;
+
+    length_cache::
+    length_cache (unsigned long limit)
+        : limit_ (limit)
+    {
+    }
+
+    void length_cache::
+    merge (const void* key, lengths& ls)
+    {
+      lock l (mutex_);
+
+      lengths& x (map_[key]);
+
+      if (x.size () < ls.size ())
+        x.resize (ls.size (), 0);
+      else if (ls.size () < x.size ())
+        ls.resize (x.size (), 0);
+
+      for (size_t i (0); i != x.size (); ++i)
+      {
+        if (x[i] < ls[i])
+          x[i] = ls[i];
+        else
+          ls[i] = x[i];
+      }
+
+      stats_.merges++;
+    }
+
+    bool length_cache::
+    record (lengths& ls, const binding& b) const
+    {
+      bool r (false);
+
+      for (size_t i (0); i != b.count; ++i)
+      {
+        const MYSQL_BIND& x (b.bind[i]);
+
+        if (x.buffer == 0 || x.error == 0 || !*x.error || x.length == 0)
+          continue;
+
+        unsigned long n (*x.length);
+
+        if (n > limit_)
+          continue;
+
+        if (ls.size () < b.count)
+          ls.resize (b.count, 0);
+
+        if (ls[i] < n)
+        {
+          ls[i] = n;
+          r = true;
+        }
+      }
+
+      return r;
+    }
+
+    bool length_cache::
+    presize (const lengths& ls, binding& b)
+    {
+      bool r (false);
+
+      for (size_t i (0); i != b.count && i != ls.size (); ++i)
+      {
+        MYSQL_BIND& x (b.bind[i]);
+
+        if (x.buffer == 0 || x.error == 0 || x.length == 0 ||
+            ls[i] <= x.buffer_length)
+          continue;
+
+        *x.length = ls[i];
+        *x.error = 1;
+        r = true;
+      }
+
+      return r;
+    }
+
+    length_cache::statistics length_cache::
+    stats () const
+    {
+      lock l (mutex_);
+      return stats_;
+    }
+  }
+}
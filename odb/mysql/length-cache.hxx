@@ -0,0 +1,103 @@
+// file      : odb/mysql/length-cache.hxx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#ifndef ODB_MYSQL_LENGTH_CACHE_HXX
+#define ODB_MYSQL_LENGTH_CACHE_HXX
+
+#include <odb/pre.hxx>
+
+#include <map>
+#include <vector>
+#include <cstddef> // std::size_t
+
+#include <odb/details/mutex.hxx>
+
+#include <odb/mysql/version.hxx>
+#include <odb/mysql/forward.hxx> // binding
+
+#include <odb/mysql/details/export.hxx>
+
+namespace odb
+{
+  namespace mysql
+  {
+    // Database-wide record of the largest lengths (high-water marks) of
+    // the result columns that were truncated when fetched into an image.
+    // The image buffers for string and binary columns start small and
+    // grow on truncation, which costs a rebind and a refetch of the
+    // truncated columns. Since the statements and images are created on
+    // each connection, every new connection would learn the lengths
+    // again. Instead, the lengths observed on one connection are used
+    // to grow the buffers on the others before the first fetch.
+    //
+    // Each connection keeps its own copy of the lengths (see
+    // object_statements) which it uses without locking. The copy is
+    // merged with the database-wide lengths when it is first needed and
+    // each time it is raised by a truncation, which becomes rare once
+    // the lengths are learned.
+    //
+    // The lengths are identified by an address that is the same for all
+    // the images of a type (for example, the find statement text) and
+    // by the column position in the binding. Lengths above the limit are
+    // not recorded since it is cheaper to refetch such rare values than
+    // to keep buffers of that size in every image. The entries are never
+    // removed. The cache is thread-safe.
+    //
+    class LIBODB_MYSQL_EXPORT length_cache
+    {
+    public:
+      typedef std::vector<unsigned long> lengths;
+
+      length_cache (unsigned long limit = 64 * 1024);
+
+      // Raise the lengths in the argument and the ones stored for the
+      // key to the greater of the two.
+      //
+      void
+      merge (const void* key, lengths&);
+
+      // Raise the lengths to the lengths of the columns in the binding
+      // that were truncated by the last fetch, up to the limit. Return
+      // true if any of them was raised.
+      //
+      bool
+      record (lengths&, const binding&) const;
+
+      // For each column in the binding that is shorter than its length,
+      // set its length to that one and its truncated flag so that the
+      // image can be grown as if it was truncated by a fetch. Return
+      // true if any column was set.
+      //
+      static bool
+      presize (const lengths&, binding&);
+
+      struct statistics
+      {
+        statistics (): merges (0) {}
+
+        std::size_t merges;
+      };
+
+      statistics
+      stats () const;
+
+    private:
+      length_cache (const length_cache&);
+      length_cache& operator= (const length_cache&);
+
+    private:
+      typedef std::map<const void*, lengths> map;
+
+      unsigned long limit_;
+
+      mutable details::mutex mutex_;
+      map map_;            // Protected by mutex_.
+      statistics stats_;   // Protected by mutex_.
+    };
+  }
+}
+
+#include <odb/post.hxx>
+
+#endif // ODB_MYSQL_LENGTH_CACHE_HXX
@@ -7,6 +7,7 @@
 
 #include <odb/pre.hxx>
 
+#include <vector>
 #include <cstddef> // std::size_t
 
 #include <odb/schema-version.hxx>
@@ -79,11 +80,28 @@ namespace odb
       void
       fetch (bool next = true);
 
+      // Collect the ids of the current and following objects so that
+      // their derived parts can be loaded in batch (see
+      // connection::polymorphic_batch()).
+      //
+      void
+      fetch_owners ();
+
+      void
+      release_owners ();
+
+      static void
+      set_owner_id (void*, std::size_t);
+
     private:
       details::shared_ptr<select_statement> statement_;
       statements_type& statements_;
       object_traits_calls<object_type> tc_;
       std::size_t count_;
+
+      std::vector<id_type> owner_ids_;
+      std::size_t owner_first_; // Position of the first owner.
+      owner_block owners_;
     };
   }
 }
@@ -19,6 +19,8 @@ namespace odb
     {
       if (!this->end_)
         statement_->free_result ();
+
+      release_owners ();
     }
 
     template <typename T>
@@ -31,6 +33,7 @@ namespace odb
         this->end_ = true;
       }
 
+      release_owners ();
       statement_.reset ();
     }
 
@@ -44,14 +47,27 @@ namespace odb
           statement_ (st),
           statements_ (sts),
           tc_ (svm),
-          count_ (0)
+          count_ (0),
+          owner_first_ (0)
     {
+      owners_.id = &sts.root_statements ().id_image_binding ();
+      owners_.count = 0;
+      owners_.current = ~std::size_t (0);
+      owners_.generation = 0;
+      owners_.set_id = &set_owner_id;
+      owners_.context = this;
     }
 
     template <typename T>
     void polymorphic_object_result_impl<T>::
     load (object_type* pobj, bool f)
     {
+      if (statement_->cached () &&
+          statements_.connection ().polymorphic_batch () > 1 &&
+          (count_ - 1 < owner_first_ ||
+           count_ - 1 >= owner_first_ + owner_ids_.size ()))
+        fetch_owners ();
+
       if (count_ > statement_->fetched ())
         fetch ();
       else if (f && statement_->cached ())
@@ -146,6 +162,12 @@ namespace odb
         idb.version++;
       }
 
+      // While this object is being loaded, its containers and derived
+      // parts can be loaded together with those of the following ones.
+      //
+      if (statements_.connection ().owners () == &owners_)
+        owners_.current = count_ - 1 - owner_first_;
+
       tc_.load_ (statements_, *pobj, false);
 
       // Load the dynamic part of the object unless static and dynamic
@@ -157,6 +179,8 @@ namespace odb
         pi.dispatch (info_type::call_load, this->db_, pobj, &d);
       };
 
+      owners_.current = ~std::size_t (0);
+
       rsts.load_delayed (tc_.version ());
       l.unlock ();
 
@@ -226,7 +250,10 @@ namespace odb
         fetch ();
 
       if (this->end_)
+      {
         statement_->free_result ();
+        release_owners ();
+      }
     }
 
     template <typename T, typename R>
@@ -336,6 +363,66 @@ namespace odb
       }
     }
 
+    template <typename T>
+    void polymorphic_object_result_impl<T>::
+    fetch_owners ()
+    {
+      connection& c (statements_.connection ());
+      typename statements_type::root_statements_type& rsts (
+        statements_.root_statements ());
+
+      std::size_t n (c.polymorphic_batch ());
+      std::size_t first (count_ - 1);
+      std::size_t size (statement_->result_size ());
+
+      // Fetch the following rows one by one and then go back to the
+      // current row which is fetched again by load().
+      //
+      std::size_t count (count_);
+      owner_ids_.clear ();
+      statement_->seek (first);
+
+      for (std::size_t i (first); i != size && owner_ids_.size () != n; ++i)
+      {
+        count_ = i + 1;
+        fetch ();
+        owner_ids_.push_back (root_traits::id (rsts.image ()));
+      }
+
+      count_ = count;
+      statement_->seek (first);
+
+      owner_first_ = first;
+
+      if (owner_ids_.size () > 1)
+      {
+        owners_.count = owner_ids_.size ();
+        c.owners (&owners_);
+      }
+      else
+        release_owners ();
+    }
+
+    template <typename T>
+    void polymorphic_object_result_impl<T>::
+    release_owners ()
+    {
+      connection& c (statements_.connection ());
+
+      if (c.owners () == &owners_)
+        c.owners (0);
+    }
+
+    template <typename T>
+    void polymorphic_object_result_impl<T>::
+    set_owner_id (void* p, std::size_t i)
+    {
+      polymorphic_object_result_impl& r (
+        *static_cast<polymorphic_object_result_impl*> (p));
+
+      r.statements_.root_statements ().init_id (r.owner_ids_[i]);
+    }
+
     template <typename T>
     void polymorphic_object_result_impl<T>::
     cache ()
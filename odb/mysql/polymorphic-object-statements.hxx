@@ -337,6 +337,26 @@ namespace odb
               select_image_bindings_[i],
               false));
 
+        // Once batch polymorphic loading is used on the connection (see
+        // connection::polymorphic_batch()), the find statement consults
+        // the multi-object statement on each execution.
+        //
+        details::shared_ptr<bulk_owner_select_statement>& b (bulk_find_[i]);
+
+        if (b == 0 && conn_.owners () != 0 && conn_.polymorphic_batch () > 1)
+        {
+          b.reset (
+            new (details::shared) bulk_owner_select_statement (
+              conn_,
+              object_traits::find_statements[i],
+              object_traits::versioned,
+              root_statements_.id_image_binding (),
+              select_image_bindings_[i]));
+
+          if (b->valid ())
+            p->batch (b.get ());
+        }
+
         return *p;
       }
 
@@ -462,6 +482,8 @@ namespace odb
       details::shared_ptr<insert_statement_type> persist_;
       details::shared_ptr<select_statement_type> find_[
         object_traits::abstract ? 1 : object_traits::depth];
+      details::shared_ptr<bulk_owner_select_statement> bulk_find_[
+        object_traits::abstract ? 1 : object_traits::depth];
       details::shared_ptr<update_statement_type> update_;
       details::shared_ptr<delete_statement_type> erase_;
     };
@@ -0,0 +1,71 @@
+// file      : odb/mysql/query-cache.cxx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#include <odb/details/lock.hxx>
+
+#include <odb/mysql/query-cache.hxx>
+
+using namespace std;
+
+namespace odb
+{
+  namespace mysql
+  {
+    using namespace details;
+
+    query_cache::
+    query_cache (size_t capacity)
+        : capacity_ (capacity)
+    {
+    }
+
+    const query_cache::translation* query_cache::
+    find (const string& s, bool& full) const
+    {
+      lock l (mutex_);
+
+      map::const_iterator i (map_.find (s));
+
+      if (i != map_.end ())
+      {
+        stats_.hits++;
+        return &i->second;
+      }
+
+      stats_.misses++;
+      full = map_.size () >= capacity_;
+      return 0;
+    }
+
+    void query_cache::
+    insert (const string& s, translation& t)
+    {
+      lock l (mutex_);
+
+      if (map_.size () >= capacity_)
+        return;
+
+      // If another thread has stored this shape first, then keep that
+      // translation; it is the same.
+      //
+      pair<map::iterator, bool> r (
+        map_.insert (map::value_type (s, translation ())));
+
+      if (r.second)
+      {
+        translation& x (r.first->second);
+        x.clause.swap (t.clause);
+        x.params.swap (t.params);
+        x.text.swap (t.text);
+      }
+    }
+
+    query_cache::statistics query_cache::
+    stats () const
+    {
+      lock l (mutex_);
+      return stats_;
+    }
+  }
+}
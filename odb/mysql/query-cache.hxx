@@ -0,0 +1,90 @@
+// file      : odb/mysql/query-cache.hxx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#ifndef ODB_MYSQL_QUERY_CACHE_HXX
+#define ODB_MYSQL_QUERY_CACHE_HXX
+
+#include <odb/pre.hxx>
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstddef> // std::size_t
+
+#include <odb/details/mutex.hxx>
+
+#include <odb/mysql/version.hxx>
+#include <odb/mysql/query.hxx>
+
+#include <odb/mysql/details/export.hxx>
+
+namespace odb
+{
+  namespace mysql
+  {
+    // Database-wide cache of the translations of the dynamic queries
+    // (odb::query_base) keyed by the query shape, that is, everything
+    // except the parameter values (see query-dynamic.cxx). The queries
+    // of the same shape translate to the same clause with the parameters
+    // in the same order so only the parameters need to be created for a
+    // shape that has already been translated. The entries are never
+    // removed and once the cache is full new shapes are no longer
+    // stored. The cache is thread-safe.
+    //
+    class LIBODB_MYSQL_EXPORT query_cache
+    {
+    public:
+      struct translation
+      {
+        std::vector<query_base::clause_part> clause;
+        std::vector<std::size_t> params; // Positions of the parameter parts.
+        std::string text;                // The clause() result.
+      };
+
+      query_cache (std::size_t capacity = 1024);
+
+      // Return the translation stored for the shape or 0 if there is
+      // none. The translation is valid for as long as the cache exists.
+      // Set full to true if no more shapes can be stored, in which case
+      // there is no need to call insert().
+      //
+      const translation*
+      find (const std::string& shape, bool& full) const;
+
+      // Store the translation unless the cache is full or the shape is
+      // already stored. The argument may be modified.
+      //
+      void
+      insert (const std::string& shape, translation&);
+
+      struct statistics
+      {
+        statistics (): hits (0), misses (0) {}
+
+        std::size_t hits;
+        std::size_t misses;
+      };
+
+      statistics
+      stats () const;
+
+    private:
+      query_cache (const query_cache&);
+      query_cache& operator= (const query_cache&);
+
+    private:
+      typedef std::map<std::string, translation> map;
+
+      std::size_t capacity_;
+
+      mutable details::mutex mutex_;
+      map map_;                    // Protected by mutex_.
+      mutable statistics stats_;   // Protected by mutex_.
+    };
+  }
+}
+
+#include <odb/post.hxx>
+
+#endif // ODB_MYSQL_QUERY_CACHE_HXX
@@ -2,8 +2,12 @@
 // copyright : Copyright (c) 2005-2015 Code Synthesis Tools CC
 // license   : GNU GPL v2; see accompanying LICENSE file
 
+#include <string>
+#include <vector>
 #include <cstddef> // std::size_t
+#include <cstring> // std::memset
 
+#include <odb/mysql/query-cache.hxx>
 #include <odb/mysql/query-dynamic.hxx>
 
 using namespace std;
@@ -12,11 +16,69 @@ namespace odb
 {
   namespace mysql
   {
+    template <typename T>
+    static inline void
+    append_key (string& k, const T& v)
+    {
+      k.append (reinterpret_cast<const char*> (&v), sizeof (T));
+    }
+
+    // Make the key that identifies the query shape, that is, everything
+    // except the parameter values.
+    //
+    static void
+    translation_key (string& k, const odb::query_base& s)
+    {
+      typedef odb::query_base::clause_part part;
+
+      for (size_t i (0), n (s.clause ().size ()); i != n; ++i)
+      {
+        const part& x (s.clause ()[i]);
+
+        append_key (k, x.kind);
+
+        switch (x.kind)
+        {
+        case part::kind_column:
+          {
+            append_key (k, x.native_info[id_mysql].column);
+            break;
+          }
+        case part::kind_param_val:
+        case part::kind_param_ref:
+          {
+            append_key (k, x.native_info[id_mysql].column);
+            append_key (k, x.native_info[id_mysql].param_factory);
+            break;
+          }
+        case part::kind_native:
+          {
+            const string& str (s.strings ()[x.data]);
+            append_key (k, str.size ());
+            k += str;
+            break;
+          }
+        default:
+          {
+            append_key (k, x.data);
+            break;
+          }
+        }
+      }
+    }
+
     static const char* logic_operators[] = {") AND (", ") OR ("};
     static const char* comp_operators[] = {"=", "!=", "<", ">", "<=", ">="};
 
+    // Translate the clause part p of s and append it to q. If params is
+    // not NULL, then record the positions of the parameter parts in the
+    // order they are appended.
+    //
     static void
-    translate (query_base& q, const odb::query_base& s, size_t p)
+    translate (query_base& q,
+               const odb::query_base& s,
+               size_t p,
+               vector<size_t>* params)
     {
       typedef odb::query_base::clause_part part;
 
@@ -36,6 +98,9 @@ namespace odb
       case part::kind_param_val:
       case part::kind_param_ref:
         {
+          if (params != 0)
+            params->push_back (p);
+
           const query_column_base* c (
             static_cast<const query_column_base*> (
               x.native_info[id_mysql].column));
@@ -64,31 +129,31 @@ namespace odb
         }
       case part::op_add:
         {
-          translate (q, s, x.data);
-          translate (q, s, p - 1);
+          translate (q, s, x.data, params);
+          translate (q, s, p - 1, params);
           break;
         }
       case part::op_and:
       case part::op_or:
         {
           q += "(";
-          translate (q, s, x.data);
+          translate (q, s, x.data, params);
           q += logic_operators[x.kind - part::op_and];
-          translate (q, s, p - 1);
+          translate (q, s, p - 1, params);
           q += ")";
           break;
         }
       case part::op_not:
         {
           q += "NOT (";
-          translate (q, s, p - 1);
+          translate (q, s, p - 1, params);
           q += ")";
           break;
         }
       case part::op_null:
       case part::op_not_null:
         {
-          translate (q, s, p - 1);
+          translate (q, s, p - 1, params);
           q += (x.kind == part::op_null ? "IS NULL" : "IS NOT NULL");
           break;
         }
@@ -98,7 +163,7 @@ namespace odb
           {
             size_t b (p - x.data);
 
-            translate (q, s, b - 1); // column
+            translate (q, s, b - 1, params); // column
             q += "IN (";
 
             for (size_t i (b); i != p; ++i)
@@ -106,7 +171,7 @@ namespace odb
               if (i != b)
                 q += ",";
 
-              translate (q, s, i);
+              translate (q, s, i, params);
             }
 
             q += ")";
@@ -118,18 +183,18 @@ namespace odb
         }
       case part::op_like:
         {
-          translate (q, s, p - 2); // column
+          translate (q, s, p - 2, params); // column
           q += "LIKE";
-          translate (q, s, p - 1); // pattern
+          translate (q, s, p - 1, params); // pattern
           break;
         }
       case part::op_like_escape:
         {
-          translate (q, s, p - 3); // column
+          translate (q, s, p - 3, params); // column
           q += "LIKE";
-          translate (q, s, p - 2); // pattern
+          translate (q, s, p - 2, params); // pattern
           q += "ESCAPE";
-          translate (q, s, p - 1); // escape
+          translate (q, s, p - 1, params); // escape
           break;
         }
       case part::op_eq:
@@ -139,9 +204,9 @@ namespace odb
       case part::op_le:
       case part::op_ge:
         {
-          translate (q, s, x.data);
+          translate (q, s, x.data, params);
           q += comp_operators[x.kind - part::op_eq];
-          translate (q, s, p - 1);
+          translate (q, s, p - 1, params);
           break;
         }
       }
@@ -149,10 +214,77 @@ namespace odb
 
     query_base::
     query_base (const odb::query_base& q)
-        : binding_ (0, 0)
+        : binding_ (0, 0), clause_text_ (0)
     {
       if (!q.empty ())
-        translate (*this, q, q.clause ().size () - 1);
+        translate (*this, q, q.clause ().size () - 1, 0);
+    }
+
+    query_base::
+    query_base (const odb::query_base& q, query_cache& c)
+        : binding_ (0, 0), clause_text_ (0)
+    {
+      if (q.empty ())
+        return;
+
+      string k;
+      translation_key (k, q);
+
+      bool full (false);
+      const query_cache::translation* t (c.find (k, full));
+
+      if (t != 0)
+      {
+        typedef odb::query_base::clause_part part;
+
+        size_t n (t->params.size ());
+        parameters_.reserve (n);
+        bind_.reserve (n);
+
+        for (size_t i (0); i != n; ++i)
+        {
+          const part& x (q.clause ()[t->params[i]]);
+
+          query_param_factory f (
+            reinterpret_cast<query_param_factory> (
+              x.native_info[id_mysql].param_factory));
+
+          const odb::query_param* p (
+            reinterpret_cast<const odb::query_param*> (x.data));
+
+          parameters_.push_back (
+            f (p->value, x.kind == part::kind_param_ref));
+
+          bind_.push_back (MYSQL_BIND ());
+          memset (&bind_.back (), 0, sizeof (MYSQL_BIND));
+          parameters_.back ()->bind (&bind_.back ());
+        }
+
+        if (n != 0)
+          update_binding ();
+
+        // Copy the text rather than point to the cached one so that this
+        // query does not depend on the lifetime of the cache.
+        //
+        clause_ = t->clause;
+        compiled_text_ = t->text;
+        clause_text_ = &compiled_text_;
+        return;
+      }
+
+      if (full)
+      {
+        translate (*this, q, q.clause ().size () - 1, 0);
+        return;
+      }
+
+      query_cache::translation e;
+      translate (*this, q, q.clause ().size () - 1, &e.params);
+
+      compile ();
+      e.clause = clause_;
+      e.text = compiled_text_;
+      c.insert (k, e);
     }
   }
 }
@@ -2,8 +2,10 @@
 // copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
 // license   : GNU GPL v2; see accompanying LICENSE file
 
-#include <cstddef> // std::size_t
-#include <cstring> // std::memset
+#include <cstddef>  // std::size_t
+#include <cstring>  // std::memset
+#include <utility>  // std::move
+#include <iterator> // std::make_move_iterator
 
 #include <odb/mysql/query.hxx>
 
@@ -27,7 +29,9 @@ namespace odb
         : clause_ (q.clause_),
           parameters_ (q.parameters_),
           bind_ (q.bind_),
-          binding_ (0, 0)
+          binding_ (0, 0),
+          clause_text_ (q.clause_text_ != 0 ? &compiled_text_ : 0),
+          compiled_text_ (q.compiled_text_)
     {
       // Here and below we want to maintain up to date binding info so
       // that the call to parameters_binding() below is an immutable
@@ -51,20 +55,71 @@ namespace odb
         clause_ = q.clause_;
         parameters_ = q.parameters_;
         bind_ = q.bind_;
+        compiled_text_ = q.compiled_text_;
+        clause_text_ = q.clause_text_ != 0 ? &compiled_text_ : 0;
 
-        size_t n (bind_.size ());
-        binding_.bind = n != 0 ? &bind_[0] : 0;
-        binding_.count = n;
-        binding_.version++;
+        update_binding ();
       }
 
       return *this;
     }
 
+#ifdef ODB_CXX11
+    query_base::
+    query_base (query_base&& q)
+        : clause_ (std::move (q.clause_)),
+          parameters_ (std::move (q.parameters_)),
+          bind_ (std::move (q.bind_)),
+          binding_ (0, 0),
+          clause_text_ (q.clause_text_ != 0 ? &compiled_text_ : 0),
+          compiled_text_ (std::move (q.compiled_text_))
+    {
+      // The parameters keep pointing to the same bind array.
+      //
+      if (!bind_.empty ())
+        update_binding ();
+
+      q.update_binding ();
+      q.clause_text_ = 0;
+    }
+
+    query_base& query_base::
+    operator= (query_base&& q)
+    {
+      if (this != &q)
+      {
+        clause_ = std::move (q.clause_);
+        parameters_ = std::move (q.parameters_);
+        bind_ = std::move (q.bind_);
+        update_binding ();
+        compiled_text_ = std::move (q.compiled_text_);
+        clause_text_ = q.clause_text_ != 0 ? &compiled_text_ : 0;
+
+        q.clause_.clear ();
+        q.parameters_.clear ();
+        q.bind_.clear ();
+        q.update_binding ();
+        q.clause_text_ = 0;
+      }
+
+      return *this;
+    }
+#endif
+
+    void query_base::
+    update_binding ()
+    {
+      size_t n (bind_.size ());
+      binding_.bind = n != 0 ? &bind_[0] : 0;
+      binding_.count = n;
+      binding_.version++;
+    }
+
     query_base& query_base::
     operator+= (const query_base& q)
     {
       clause_.insert (clause_.end (), q.clause_.begin (), q.clause_.end ());
+      clause_text_ = 0;
 
       size_t n (bind_.size ());
 
@@ -84,9 +139,35 @@ namespace odb
       return *this;
     }
 
+#ifdef ODB_CXX11
+    query_base& query_base::
+    operator+= (query_base&& q)
+    {
+      clause_.insert (clause_.end (),
+                      make_move_iterator (q.clause_.begin ()),
+                      make_move_iterator (q.clause_.end ()));
+      clause_text_ = 0;
+
+      size_t n (bind_.size ());
+
+      parameters_.insert (
+        parameters_.end (), q.parameters_.begin (), q.parameters_.end ());
+
+      bind_.insert (
+        bind_.end (), q.bind_.begin (), q.bind_.end ());
+
+      if (n != bind_.size ())
+        update_binding ();
+
+      return *this;
+    }
+#endif
+
     void query_base::
     append (const string& q)
     {
+      clause_text_ = 0;
+
       if (!clause_.empty () &&
           clause_.back ().kind == clause_part::kind_native)
       {
@@ -111,6 +192,8 @@ namespace odb
     void query_base::
     append (const char* table, const char* column)
     {
+      clause_text_ = 0;
+
       string s (table);
       s += '.';
       s += column;
@@ -118,22 +201,63 @@ namespace odb
       clause_.push_back (clause_part (clause_part::kind_column, s));
     }
 
+    void query_base::
+    prepend (const string& q)
+    {
+      clause_text_ = 0;
+
+      if (!clause_.empty () &&
+          clause_.front ().kind == clause_part::kind_native)
+      {
+        string& s (clause_.front ().part);
+
+        char last (!q.empty () ? q[q.size () - 1] : ' ');
+        char first (!s.empty () ? s[0] : ' ');
+
+        // The same spacing rules as in append() above.
+        //
+        if (last != ' ' && last != '\n' && last != '(' &&
+            first != ' ' && first != '\n' && first != ',' && first != ')')
+          s.insert (0, 1, ' ');
+
+        s.insert (0, q);
+      }
+      else
+        clause_.insert (clause_.begin (),
+                        clause_part (clause_part::kind_native, q));
+    }
+
     void query_base::
     append (details::shared_ptr<query_param> p, const char* conv)
     {
-      clause_.push_back (clause_part (clause_part::kind_param));
+      clause_text_ = 0;
 
-      if (conv != 0)
-        clause_.back ().part = conv;
+      // A parameter can bind several comma-separated values (see
+      // query_param_array).
+      //
+      size_t n (p->count ());
+
+      for (size_t i (0); i != n; ++i)
+      {
+        if (i != 0)
+          append (",");
+
+        clause_.push_back (clause_part (clause_part::kind_param));
+
+        if (conv != 0)
+          clause_.back ().part = conv;
+      }
 
       parameters_.push_back (p);
-      bind_.push_back (MYSQL_BIND ());
+
+      size_t i (bind_.size ());
+      bind_.resize (i + n);
       binding_.bind = &bind_[0];
       binding_.count = bind_.size ();
       binding_.version++;
 
-      MYSQL_BIND* b (&bind_.back ());
-      memset (b, 0, sizeof (MYSQL_BIND));
+      MYSQL_BIND* b (&bind_[i]);
+      memset (b, 0, n * sizeof (MYSQL_BIND));
       p->bind (b);
     }
 
@@ -142,7 +266,7 @@ namespace odb
     {
       bool inc_ver (false);
 
-      for (size_t i (0); i < parameters_.size (); ++i)
+      for (size_t i (0), j (0); i < parameters_.size (); ++i)
       {
         query_param& p (*parameters_[i]);
 
@@ -150,10 +274,12 @@ namespace odb
         {
           if (p.init ())
           {
-            p.bind (&bind_[i]);
+            p.bind (&bind_[j]);
             inc_ver = true;
           }
         }
+
+        j += p.count ();
       }
 
       if (inc_ver)
@@ -208,7 +334,10 @@ namespace odb
 
         if (j == e ||
             (j->kind == clause_part::kind_native && check_prefix (j->part)))
+        {
           clause_.erase (i);
+          clause_text_ = 0;
+        }
       }
     }
 
@@ -228,9 +357,22 @@ namespace odb
       return "";
     }
 
+    void query_base::
+    compile ()
+    {
+      if (clause_text_ == 0)
+      {
+        compiled_text_ = clause ();
+        clause_text_ = &compiled_text_;
+      }
+    }
+
     string query_base::
     clause () const
     {
+      if (clause_text_ != 0)
+        return *clause_text_;
+
       string r;
 
       for (clause_type::const_iterator i (clause_.begin ()),
@@ -343,5 +485,44 @@ namespace odb
       r += ")";
       return r;
     }
+
+#ifdef ODB_CXX11
+    query_base
+    operator&& (query_base&& x, const query_base& y)
+    {
+      bool xt (x.const_true ()), yt (y.const_true ());
+
+      if (xt && !yt)
+        return y;
+
+      if (!xt && !yt)
+      {
+        x.prepend ("(");
+        x += ") AND (";
+        x += y;
+        x += ")";
+      }
+
+      return std::move (x);
+    }
+
+    query_base
+    operator|| (query_base&& x, const query_base& y)
+    {
+      x.prepend ("(");
+      x += ") OR (";
+      x += y;
+      x += ")";
+      return std::move (x);
+    }
+
+    query_base
+    operator! (query_base&& x)
+    {
+      x.prepend ("NOT (");
+      x += ")";
+      return std::move (x);
+    }
+#endif
   }
 }
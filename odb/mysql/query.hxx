@@ -10,9 +10,11 @@
 #include <string>
 #include <vector>
 #include <cstddef> // std::size_t
+#include <utility> // std::move
 
 #include <odb/forward.hxx> // odb::query_column
 #include <odb/query.hxx>
+#include <odb/details/config.hxx> // ODB_CXX11
 
 #include <odb/mysql/mysql.hxx>
 #include <odb/mysql/version.hxx>
@@ -114,9 +116,17 @@ namespace odb
       virtual bool
       init () = 0;
 
+      // Bind count() consecutive entries starting with the specified one.
+      //
       virtual void
       bind (MYSQL_BIND*) = 0;
 
+      virtual std::size_t
+      count () const
+      {
+        return 1;
+      }
+
     protected:
       query_param (const void* value) : value_ (value) {}
 
@@ -152,7 +162,7 @@ namespace odb
       };
 
       query_base ()
-        : binding_ (0, 0)
+        : binding_ (0, 0), clause_text_ (0)
       {
       }
 
@@ -160,27 +170,27 @@ namespace odb
       //
       explicit
       query_base (bool v)
-        : binding_ (0, 0)
+        : binding_ (0, 0), clause_text_ (0)
       {
         append (v);
       }
 
       explicit
       query_base (const char* native)
-        : binding_ (0, 0)
+        : binding_ (0, 0), clause_text_ (0)
       {
         clause_.push_back (clause_part (clause_part::kind_native, native));
       }
 
       explicit
       query_base (const std::string& native)
-        : binding_ (0, 0)
+        : binding_ (0, 0), clause_text_ (0)
       {
         clause_.push_back (clause_part (clause_part::kind_native, native));
       }
 
       query_base (const char* table, const char* column)
-        : binding_ (0, 0)
+        : binding_ (0, 0), clause_text_ (0)
       {
         append (table, column);
       }
@@ -188,7 +198,7 @@ namespace odb
       template <typename T>
       explicit
       query_base (val_bind<T> v)
-        : binding_ (0, 0)
+        : binding_ (0, 0), clause_text_ (0)
       {
         *this += v;
       }
@@ -196,7 +206,7 @@ namespace odb
       template <typename T, database_type_id ID>
       explicit
       query_base (val_bind_typed<T, ID> v)
-        : binding_ (0, 0)
+        : binding_ (0, 0), clause_text_ (0)
       {
         *this += v;
       }
@@ -204,7 +214,7 @@ namespace odb
       template <typename T>
       explicit
       query_base (ref_bind<T> r)
-        : binding_ (0, 0)
+        : binding_ (0, 0), clause_text_ (0)
       {
         *this += r;
       }
@@ -212,7 +222,7 @@ namespace odb
       template <typename T, database_type_id ID>
       explicit
       query_base (ref_bind_typed<T, ID> r)
-        : binding_ (0, 0)
+        : binding_ (0, 0), clause_text_ (0)
       {
         *this += r;
       }
@@ -220,10 +230,12 @@ namespace odb
       template <database_type_id ID>
       query_base (const query_column<bool, ID>&);
 
-      // Translate common query representation to MySQL native. Defined
-      // in query-dynamic.cxx
+      // Translate common query representation to MySQL native. The
+      // second version reuses the translations of the queries of the
+      // same shape stored in the cache. Defined in query-dynamic.cxx
       //
       query_base (const odb::query_base&);
+      query_base (const odb::query_base&, query_cache&);
 
       // Copy c-tor and assignment.
       //
@@ -232,6 +244,17 @@ namespace odb
       query_base&
       operator= (const query_base&);
 
+      // Move c-tor and assignment. Composing a query from temporaries
+      // (for example, with operator&&) reuses the storage of the left
+      // operand instead of copying it.
+      //
+#ifdef ODB_CXX11
+      query_base (query_base&&);
+
+      query_base&
+      operator= (query_base&&);
+#endif
+
     public:
       std::string
       clause () const;
@@ -267,6 +290,15 @@ namespace odb
       void
       optimize ();
 
+      // Build the clause text once so that the following clause() calls
+      // return it instead of rebuilding it. This is meant for the queries
+      // with a fixed structure that are constructed once (for example,
+      // as static objects with by-reference parameters) and executed
+      // many times. Modifying the query discards the compiled text.
+      //
+      void
+      compile ();
+
     public:
       template <typename T>
       static val_bind<T>
@@ -335,6 +367,11 @@ namespace odb
       query_base&
       operator+= (const query_base&);
 
+#ifdef ODB_CXX11
+      query_base&
+      operator+= (query_base&&);
+#endif
+
       query_base&
       operator+= (const std::string& q)
       {
@@ -400,6 +437,7 @@ namespace odb
       append (bool v)
       {
         clause_.push_back (clause_part (v));
+        clause_text_ = 0;
       }
 
       void
@@ -414,6 +452,17 @@ namespace odb
       void
       append (const char* table, const char* column);
 
+      // Insert the native SQL fragment at the beginning of the clause.
+      //
+      void
+      prepend (const std::string& native);
+
+    private:
+      // Point binding_ to bind_ after it has changed.
+      //
+      void
+      update_binding ();
+
     private:
       typedef std::vector<clause_part> clause_type;
       typedef std::vector<details::shared_ptr<query_param> > parameters_type;
@@ -422,6 +471,13 @@ namespace odb
       parameters_type parameters_;
       mutable std::vector<MYSQL_BIND> bind_;
       mutable binding binding_;
+
+      // Text returned by clause() if known. It points to compiled_text_
+      // that is set either by compile() or from the cached translation
+      // of an odb::query_base (see query-dynamic.cxx).
+      //
+      const std::string* clause_text_;
+      std::string compiled_text_;
     };
 
     inline query_base
@@ -432,6 +488,15 @@ namespace odb
       return r;
     }
 
+#ifdef ODB_CXX11
+    inline query_base
+    operator+ (query_base&& x, const query_base& y)
+    {
+      x += y;
+      return std::move (x);
+    }
+#endif
+
     template <typename T>
     inline query_base
     operator+ (const query_base& q, val_bind<T> b)
@@ -609,6 +674,17 @@ namespace odb
     LIBODB_MYSQL_EXPORT query_base
     operator! (const query_base& x);
 
+#ifdef ODB_CXX11
+    LIBODB_MYSQL_EXPORT query_base
+    operator&& (query_base&& x, const query_base& y);
+
+    LIBODB_MYSQL_EXPORT query_base
+    operator|| (query_base&& x, const query_base& y);
+
+    LIBODB_MYSQL_EXPORT query_base
+    operator! (query_base&& x);
+#endif
+
     // query_column
     //
     struct LIBODB_MYSQL_EXPORT query_column_base
@@ -704,6 +780,16 @@ namespace odb
       query_base
       in_range (I begin, I end) const;
 
+      // As above but pad the list to the next power of two by repeating
+      // the last value so that lists of different lengths produce a few
+      // distinct statement texts that can be reused. For the types with
+      // fixed-size images (numbers and dates) the values are bound from
+      // a single array parameter. The iterator must be a forward one.
+      //
+      template <typename I>
+      query_base
+      in_range_padded (I begin, I end) const;
+
       // like
       //
     public:
@@ -2132,6 +2218,138 @@ namespace odb
       details::buffer buffer_;
       unsigned long size_;
     };
+
+    // Whether the parameter image of a type has a fixed size, in which
+    // case the values of an IN list can be bound from one array of
+    // query_param_impl objects (see query_param_array).
+    //
+    template <database_type_id>
+    struct query_param_packed {static const bool value = false;};
+
+    template <>
+    struct query_param_packed<id_tiny> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_utiny> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_short> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_ushort> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_long> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_ulong> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_longlong> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_ulonglong> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_float> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_double> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_date> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_time> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_datetime> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_timestamp> {static const bool value = true;};
+
+    template <>
+    struct query_param_packed<id_year> {static const bool value = true;};
+
+    // By-value parameter that binds the values of an IN list, padded to
+    // the specified size by repeating the last value, from one array.
+    //
+    template <typename T, database_type_id ID>
+    struct query_param_array: query_param
+    {
+      template <typename I>
+      query_param_array (I begin, I end, std::size_t size)
+          : query_param (0)
+      {
+        elements_.reserve (size);
+
+        for (; begin != end; ++begin)
+          elements_.push_back (element_type (val_bind<T> (*begin)));
+
+        while (elements_.size () < size)
+          elements_.push_back (elements_.back ());
+      }
+
+      virtual bool
+      init ()
+      {
+        return false;
+      }
+
+      virtual void
+      bind (MYSQL_BIND* b)
+      {
+        for (std::size_t i (0); i != elements_.size (); ++i)
+          elements_[i].bind (b + i);
+      }
+
+      virtual std::size_t
+      count () const
+      {
+        return elements_.size ();
+      }
+
+    private:
+      typedef query_param_impl<T, ID> element_type;
+      std::vector<element_type> elements_;
+    };
+
+    // Append the padded IN list values (see query_column::in_range_padded()).
+    //
+    template <typename T, database_type_id ID, bool packed>
+    struct query_in_list
+    {
+      template <typename I>
+      static void
+      append (query_base& q, I b, I e, std::size_t size, const char* conv)
+      {
+        q.append (
+          details::shared_ptr<query_param> (
+            new (details::shared) query_param_array<T, ID> (b, e, size)),
+          conv);
+      }
+    };
+
+    template <typename T, database_type_id ID>
+    struct query_in_list<T, ID, false>
+    {
+      template <typename I>
+      static void
+      append (query_base& q, I b, I e, std::size_t size, const char* conv)
+      {
+        I l (b);
+        for (std::size_t i (0); i != size; ++i)
+        {
+          if (i != 0)
+            q += ",";
+
+          if (b != e)
+            l = b++;
+
+          q.append<T, ID> (val_bind<T> (*l), conv);
+        }
+      }
+    };
   }
 }
 
@@ -2191,6 +2409,13 @@ namespace odb
       {
       }
 
+#ifdef ODB_CXX11
+      query (query_base&& q)
+          : query_base (std::move (q))
+      {
+      }
+#endif
+
       template <database_type_id ID>
       query (const query_column<bool, ID>& qc)
           : query_base (qc)
@@ -2261,6 +2486,13 @@ namespace odb
     {
     }
 
+#ifdef ODB_CXX11
+    query (mysql::query_base&& q)
+        : mysql::query<T> (std::move (q))
+    {
+    }
+#endif
+
     template <mysql::database_type_id ID>
     query (const mysql::query_column<bool, ID>& qc)
         : mysql::query<T> (qc)
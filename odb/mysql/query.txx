@@ -13,7 +13,7 @@ namespace odb
     template <database_type_id ID>
     query_base::
     query_base (const query_column<bool, ID>& c)
-        : binding_ (0, 0)
+        : binding_ (0, 0), clause_text_ (0)
     {
       // Cannot use IS TRUE here since database type can be a non-
       // integral type.
@@ -120,6 +120,30 @@ namespace odb
         return query_base (false);
     }
 
+    template <typename T, database_type_id ID>
+    template <typename I>
+    query_base query_column<T, ID>::
+    in_range_padded (I begin, I end) const
+    {
+      if (begin == end)
+        return query_base (false);
+
+      std::size_t n (0);
+      for (I i (begin); i != end; ++i)
+        n++;
+
+      std::size_t size (1);
+      while (size < n)
+        size *= 2;
+
+      query_base q (table_, column_);
+      q += "IN (";
+      query_in_list<T, ID, query_param_packed<ID>::value>::append (
+        q, begin, end, size, conversion_);
+      q += ")";
+      return q;
+    }
+
     // like
     //
     template <typename T, database_type_id ID>
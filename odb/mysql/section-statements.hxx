@@ -119,6 +119,25 @@ namespace odb
               select_image_binding_,
               false));
 
+        // While the owners of several objects are published on the
+        // connection (see database::load(first, last, section)), the
+        // select statement consults the multi-owner statement on each
+        // execution.
+        //
+        if (bulk_select_ == 0 && conn_.owners () != 0)
+        {
+          bulk_select_.reset (
+            new (details::shared) bulk_owner_select_statement (
+              conn_,
+              traits::select_statement,
+              traits::versioned,
+              id_binding_,
+              select_image_binding_));
+
+          if (bulk_select_->valid ())
+            select_->batch (bulk_select_.get ());
+        }
+
         return *select_;
       }
 
@@ -190,6 +209,7 @@ namespace odb
 
       details::shared_ptr<select_statement_type> select_;
       details::shared_ptr<update_statement_type> update_;
+      details::shared_ptr<bulk_owner_select_statement> bulk_select_;
     };
   }
 }
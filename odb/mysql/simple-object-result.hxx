@@ -36,6 +36,7 @@ namespace odb
       typedef object_traits_impl<object_type, id_mysql> object_traits;
       typedef typename base_type::pointer_traits pointer_traits;
 
+      typedef typename object_traits::image_type image_type;
       typedef typename object_traits::statements_type statements_type;
 
       virtual
@@ -70,11 +71,53 @@ namespace odb
       void
       fetch (bool next = true);
 
+      // Fetch the next block of rows (see connection::fetch_block()).
+      //
+      void
+      fetch_block ();
+
+      // Stop loading containers of the objects in the current block in
+      // batch (see connection::container_batch()).
+      //
+      void
+      release_owners ();
+
+      static void
+      set_owner_id (void*, std::size_t);
+
     private:
+      // Image of a row in the block with its own select binding. The
+      // binding is never bound to the statement; it describes the image
+      // buffers the row is copied into (see select_statement::copy()).
+      //
+      struct block_image
+      {
+        block_image ();
+
+        image_type image;
+
+        binding b;
+        MYSQL_BIND bind[statements_type::select_column_count];
+        my_bool truncated[statements_type::select_column_count];
+
+      private:
+        block_image (const block_image&);
+        block_image& operator= (const block_image&);
+      };
+
       details::shared_ptr<select_statement> statement_;
       statements_type& statements_;
       object_traits_calls<object_type> tc_;
       std::size_t count_;
+
+      block_image* block_;      // 0 if not fetching in blocks.
+      std::size_t block_size_;  // Capacity.
+      std::size_t block_count_; // Number of rows in the current block.
+      std::size_t block_pos_;   // Position of the next row in the block.
+      bool block_end_;          // Last block has been fetched.
+      std::size_t block_rows_;  // Number of rows in all the blocks so far.
+
+      owner_block owners_; // Objects in the current block.
     };
   }
 }
@@ -3,6 +3,7 @@
 // license   : GNU GPL v2; see accompanying LICENSE file
 
 #include <cassert>
+#include <cstring> // std::memset
 
 #include <odb/callback.hxx>
 #include <odb/exceptions.hxx> // result_not_cached
@@ -13,12 +14,30 @@ namespace odb
 {
   namespace mysql
   {
+    template <typename T>
+    object_result_impl<T>::block_image::
+    block_image ()
+        : b (bind, statements_type::select_column_count)
+    {
+      image.version = 0;
+
+      std::memset (bind, 0, sizeof (bind));
+      std::memset (truncated, 0, sizeof (truncated));
+
+      for (std::size_t i (0); i < statements_type::select_column_count; ++i)
+        bind[i].error = truncated + i;
+    }
+
     template <typename T>
     object_result_impl<T>::
     ~object_result_impl ()
     {
       if (!this->end_)
         statement_->free_result ();
+
+      release_owners ();
+
+      delete[] block_;
     }
 
     template <typename T>
@@ -31,6 +50,7 @@ namespace odb
         this->end_ = true;
       }
 
+      release_owners ();
       statement_.reset ();
     }
 
@@ -44,22 +64,57 @@ namespace odb
           statement_ (statement),
           statements_ (statements),
           tc_ (svm),
-          count_ (0)
+          count_ (0),
+          block_ (0),
+          block_size_ (statements.connection ().fetch_block ()),
+          block_count_ (0),
+          block_pos_ (0),
+          block_end_ (false),
+          block_rows_ (0)
     {
+      if (block_size_ > 1)
+        block_ = new block_image[block_size_];
+
+      // The select image has been bound by the query. Grow it to the
+      // lengths learned from the earlier results before the first fetch.
+      //
+      typename object_traits::image_type& im (statements.image ());
+      binding& b (statements.select_image_binding ());
+
+      if (statements.presize_image (
+            tc_, im, b, statements.select_image_truncated ()))
+      {
+        tc_.bind (b.bind, im, statement_select);
+        statements.select_image_version (im.version);
+        b.version++;
+      }
+
+      owners_.id = &statements.id_image_binding ();
+      owners_.count = 0;
+      owners_.current = ~std::size_t (0);
+      owners_.generation = 0;
+      owners_.set_id = &set_owner_id;
+      owners_.context = this;
     }
 
     template <typename T>
     void object_result_impl<T>::
     load (object_type& obj, bool f)
     {
-      if (count_ > statement_->fetched ())
-        fetch ();
-      else if (f && statement_->cached ())
+      // When fetching in blocks, each row has its own image which cannot
+      // be overwritten by other statements.
+      //
+      if (block_ == 0)
       {
-        // We have to re-load the image in case it has been overwritten
-        // between the last time we fetched and this call to load().
-        //
-        fetch (false);
+        if (count_ > statement_->fetched ())
+          fetch ();
+        else if (f && statement_->cached ())
+        {
+          // We have to re-load the image in case it has been overwritten
+          // between the last time we fetched and this call to load().
+          //
+          fetch (false);
+        }
       }
 
       // This is a top-level call so the statements cannot be locked.
@@ -69,24 +124,23 @@ namespace odb
 
       object_traits::callback (this->db_, obj, callback_event::pre_load);
 
-      typename object_traits::image_type& i (statements_.image ());
+      image_type& i (
+        block_ != 0 ? block_[block_pos_ - 1].image : statements_.image ());
       tc_.init (obj, i, &this->db_);
 
       // Initialize the id image and binding and load the rest of the object
       // (containers, etc).
       //
-      typename object_traits::id_image_type& idi (statements_.id_image ());
-      object_traits::init (idi, object_traits::id (i));
+      statements_.init_id (object_traits::id (i));
 
-      binding& idb (statements_.id_image_binding ());
-      if (idi.version != statements_.id_image_version () || idb.version == 0)
-      {
-        object_traits::bind (idb.bind, idi);
-        statements_.id_image_version (idi.version);
-        idb.version++;
-      }
+      // While this object is being loaded, its containers can be loaded
+      // together with those of the rest of the block.
+      //
+      if (block_ != 0)
+        owners_.current = block_pos_ - 1;
 
       tc_.load_ (statements_, obj, false);
+      owners_.current = ~std::size_t (0);
       statements_.load_delayed (tc_.version ());
       l.unlock ();
       object_traits::callback (this->db_, obj, callback_event::post_load);
@@ -97,6 +151,9 @@ namespace odb
     object_result_impl<T>::
     load_id ()
     {
+      if (block_ != 0)
+        return object_traits::id (block_[block_pos_ - 1].image);
+
       if (count_ > statement_->fetched ())
         fetch ();
       else if (statement_->cached ())
@@ -126,13 +183,26 @@ namespace odb
       //
       count_++;
 
-      if (statement_->cached ())
+      if (block_ != 0)
+      {
+        if (block_pos_ == block_count_)
+          fetch_block ();
+
+        if (block_pos_ != block_count_)
+          block_pos_++;
+        else
+          this->end_ = true;
+      }
+      else if (statement_->cached ())
         this->end_ = count_ > statement_->result_size ();
       else
         fetch ();
 
       if (this->end_)
+      {
         statement_->free_result ();
+        release_owners ();
+      }
     }
 
     template <typename T>
@@ -170,6 +240,8 @@ namespace odb
 
             typename object_traits::image_type& im (statements_.image ());
 
+            statements_.record_lengths (statements_.select_image_binding ());
+
             if (tc_.grow (im, statements_.select_image_truncated ()))
               im.version++;
 
@@ -201,11 +273,138 @@ namespace odb
       }
     }
 
+    template <typename T>
+    void object_result_impl<T>::
+    fetch_block ()
+    {
+      block_count_ = 0;
+      block_pos_ = 0;
+
+      // The rows are fetched into the select image, which stays bound to
+      // the statement, and then copied into the block images. Fetching
+      // directly into the block images would make the statement rebind
+      // its result for every row.
+      //
+      // The block images are reused from block to block so their buffers
+      // quickly grow to the size of the largest values in the result
+      // and growing them while copying becomes rare.
+      //
+      typename object_traits::image_type& im (statements_.image ());
+      binding& imb (statements_.select_image_binding ());
+
+      // The image can grow between blocks as a result of other statements
+      // execution.
+      //
+      if (im.version != statements_.select_image_version ())
+      {
+        tc_.bind (imb.bind, im, statement_select);
+        statements_.select_image_version (im.version);
+        imb.version++;
+      }
+
+      while (!block_end_ && block_count_ != block_size_)
+      {
+        select_statement::result r (statement_->fetch ());
+
+        if (r == select_statement::no_data)
+        {
+          // Release the connection for other statements while we are
+          // still returning objects from the last block.
+          //
+          statement_->free_result ();
+          block_end_ = true;
+          break;
+        }
+
+        if (r == select_statement::truncated)
+        {
+          statements_.record_lengths (imb);
+
+          if (tc_.grow (im, statements_.select_image_truncated ()))
+            im.version++;
+
+          if (im.version != statements_.select_image_version ())
+          {
+            tc_.bind (imb.bind, im, statement_select);
+            statements_.select_image_version (im.version);
+            imb.version++;
+            statement_->refetch ();
+          }
+        }
+
+        block_image& bi (block_[block_count_]);
+
+        if (bi.b.version == 0)
+        {
+          // First use of this image. Grow it to the lengths learned from
+          // the earlier results.
+          //
+          tc_.bind (bi.b.bind, bi.image, statement_select);
+
+          if (statements_.presize_image (tc_, bi.image, bi.b, bi.truncated))
+            tc_.bind (bi.b.bind, bi.image, statement_select);
+
+          bi.b.version++;
+        }
+
+        if (!select_statement::copy (imb, bi.b))
+        {
+          // Some of the values don't fit into the block image. Grow it
+          // and copy the row again.
+          //
+          tc_.grow (bi.image, bi.truncated);
+          std::memset (bi.truncated, 0, sizeof (bi.truncated));
+
+          tc_.bind (bi.b.bind, bi.image, statement_select);
+          bi.b.version++;
+
+          select_statement::copy (imb, bi.b);
+        }
+
+        block_count_++;
+        block_rows_++;
+      }
+
+      // Let the containers of the objects in this block be loaded in
+      // batch, if requested.
+      //
+      connection& c (statements_.connection ());
+
+      if (c.container_batch () && block_count_ > 1)
+      {
+        owners_.count = block_count_;
+        c.owners (&owners_);
+      }
+      else
+        release_owners ();
+    }
+
+    template <typename T>
+    void object_result_impl<T>::
+    release_owners ()
+    {
+      connection& c (statements_.connection ());
+
+      if (c.owners () == &owners_)
+        c.owners (0);
+    }
+
+    template <typename T>
+    void object_result_impl<T>::
+    set_owner_id (void* p, std::size_t i)
+    {
+      object_result_impl& r (*static_cast<object_result_impl*> (p));
+      r.statements_.init_id (object_traits::id (r.block_[i].image));
+    }
+
     template <typename T>
     void object_result_impl<T>::
     cache ()
     {
-      if (!this->end_ && !statement_->cached ())
+      // If the last block has been fetched, then its result has already
+      // been freed and the rows are all in the block (see size()).
+      //
+      if (!this->end_ && !statement_->cached () && !block_end_)
       {
         statement_->cache ();
 
@@ -224,6 +423,9 @@ namespace odb
     {
       if (!this->end_)
       {
+        if (block_end_)
+          return block_rows_;
+
         if (!statement_->cached ())
           throw result_not_cached ();
 
@@ -22,6 +22,8 @@
 #include <odb/mysql/binding.hxx>
 #include <odb/mysql/statement.hxx>
 #include <odb/mysql/statements-base.hxx>
+#include <odb/mysql/traits-calls.hxx>
+#include <odb/mysql/length-cache.hxx>
 
 #include <odb/mysql/details/export.hxx>
 
@@ -255,13 +257,18 @@ namespace odb
                                        object_type&,
                                        const schema_version_migration*);
 
+      // If found is not NULL, then the object is allowed to not exist in
+      // the database in which case false is stored in *found and the
+      // object is removed from the session cache.
+      //
       void
       delay_load (const id_type& id,
                   object_type& obj,
                   const typename pointer_cache_traits::position_type& p,
-                  loader_function l = 0)
+                  loader_function l = 0,
+                  bool* found = 0)
       {
-        delayed_.push_back (delayed_load (id, obj, p, l));
+        delayed_.push_back (delayed_load (id, obj, p, l, found));
       }
 
       void
@@ -270,7 +277,7 @@ namespace odb
         assert (locked ());
 
         if (!delayed_.empty ())
-          load_delayed_<object_statements> (svm);
+          load_delayed_<object_statements> (svm, true);
       }
 
       void
@@ -327,6 +334,24 @@ namespace odb
       my_bool*
       select_image_truncated () {return select_image_truncated_;}
 
+      // Grow the buffers in the image for the columns that were fetched
+      // longer than them on any connection (see length_cache) so that
+      // they are not truncated and refetched. The binding must be bound
+      // to the image and the truncated flags must be its error array.
+      // Return true if the image has grown and should be rebound.
+      //
+      bool
+      presize_image (object_traits_calls<T>&,
+                     image_type&,
+                     binding&,
+                     my_bool* truncated);
+
+      // Record the lengths of the columns truncated by the last fetch
+      // into an image bound with this binding.
+      //
+      void
+      record_lengths (const binding&);
+
       // Object id image and binding.
       //
       id_image_type&
@@ -341,6 +366,11 @@ namespace odb
       binding&
       id_image_binding () {return id_image_binding_;}
 
+      // Initialize the id image and binding with the specified id.
+      //
+      void
+      init_id (const id_type&);
+
       // Optimistic id + managed column image binding. It points to
       // the same suffix as id binding and they are always updated
       // at the same time.
@@ -366,6 +396,24 @@ namespace odb
         return *persist_;
       }
 
+      // Multi-row version of the find statement used to batch delayed
+      // loads.
+      //
+      bulk_select_statement&
+      bulk_find_statement ()
+      {
+        if (bulk_find_ == 0)
+          bulk_find_.reset (
+            new (details::shared) bulk_select_statement (
+              conn_,
+              object_traits::find_statement,
+              object_traits::versioned, // Process if versioned.
+              id_image_binding_,
+              select_image_binding_));
+
+        return *bulk_find_;
+      }
+
       select_statement_type&
       find_statement ()
       {
@@ -387,6 +435,7 @@ namespace odb
       update_statement ()
       {
         if (update_ == 0)
+        {
           update_.reset (
             new (details::shared) update_statement_type (
               conn_,
@@ -395,6 +444,13 @@ namespace odb
               update_image_binding_,
               false));
 
+          // Without optimistic concurrency the outcome of an update
+          // does not depend on the object state so it can be batched.
+          //
+          if (managed_optimistic_column_count == 0)
+            update_->batchable (id_column_count);
+        }
+
         return *update_;
       }
 
@@ -402,6 +458,7 @@ namespace odb
       erase_statement ()
       {
         if (erase_ == 0)
+        {
           erase_.reset (
             new (details::shared) delete_statement_type (
               conn_,
@@ -409,6 +466,13 @@ namespace odb
               id_image_binding_,
               false));
 
+          // The outcome of a delete does not depend on the object state.
+          // For objects with containers, the container statements flush
+          // the pending rows before each object (see database::erase()).
+          //
+          erase_->batchable (true);
+        }
+
         return *erase_;
       }
 
@@ -471,9 +535,13 @@ namespace odb
       object_statements& operator= (const object_statements&);
 
     protected:
+      // If batch is true, then the delayed loads that use the default
+      // loader are loaded several objects at a time with the multi-row
+      // find statement.
+      //
       template <typename STS>
       void
-      load_delayed_ (const schema_version_migration*);
+      load_delayed_ (const schema_version_migration*, bool batch = false);
 
       void
       clear_delayed_ ();
@@ -495,6 +563,12 @@ namespace odb
       MYSQL_BIND select_image_bind_[select_column_count];
       my_bool select_image_truncated_[select_column_count];
 
+      // Lengths of the select image columns learned on this and other
+      // connections (see length_cache).
+      //
+      length_cache::lengths select_lengths_;
+      bool select_lengths_init_;
+
       // Insert binding.
       //
       std::size_t insert_image_version_;
@@ -528,6 +602,7 @@ namespace odb
 
       details::shared_ptr<insert_statement_type> persist_;
       details::shared_ptr<select_statement_type> find_;
+      details::shared_ptr<bulk_select_statement> bulk_find_;
       details::shared_ptr<update_statement_type> update_;
       details::shared_ptr<delete_statement_type> erase_;
 
@@ -541,8 +616,9 @@ namespace odb
         delayed_load (const id_type& i,
                       object_type& o,
                       const position_type& p,
-                      loader_function l)
-            : id (i), obj (&o), pos (p), loader (l)
+                      loader_function l,
+                      bool* f)
+            : id (i), obj (&o), pos (p), loader (l), found (f)
         {
         }
 
@@ -550,11 +626,19 @@ namespace odb
         object_type* obj;
         position_type pos;
         loader_function loader;
+        bool* found;
       };
 
       typedef std::vector<delayed_load> delayed_loads;
       delayed_loads delayed_;
 
+      // Load a batch of delayed loads from the end of the list and remove
+      // them from it. Return false if nothing was loaded.
+      //
+      template <typename STS>
+      bool
+      load_delayed_batch_ (delayed_loads&, const schema_version_migration*);
+
       // Delayed vectors swap guard. See the load_delayed_() function for
       // details.
       //
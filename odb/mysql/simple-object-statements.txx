@@ -8,6 +8,7 @@
 #include <odb/exceptions.hxx>
 
 #include <odb/mysql/connection.hxx>
+#include <odb/mysql/database.hxx> // length_cache
 #include <odb/mysql/traits-calls.hxx>
 
 namespace odb
@@ -53,6 +54,7 @@ namespace odb
     {
       image_.version = 0;
       select_image_version_ = 0;
+      select_lengths_init_ = false;
       insert_image_version_ = 0;
       update_image_version_ = 0;
       update_id_image_version_ = 0;
@@ -73,7 +75,7 @@ namespace odb
     template <typename T>
     template <typename STS>
     void object_statements<T>::
-    load_delayed_ (const schema_version_migration* svm)
+    load_delayed_ (const schema_version_migration* svm, bool batch)
     {
       database& db (connection ().database ());
 
@@ -82,6 +84,9 @@ namespace odb
 
       while (!dls.empty ())
       {
+        if (batch && load_delayed_batch_<STS> (dls, svm))
+          continue;
+
         delayed_load l (dls.back ());
         typename pointer_cache_traits::insert_guard ig (l.pos);
         dls.pop_back ();
@@ -91,7 +96,13 @@ namespace odb
           object_traits_calls<T> tc (svm);
 
           if (!tc.find_ (static_cast<STS&> (*this), &l.id))
-            throw object_not_persistent ();
+          {
+            if (l.found == 0)
+              throw object_not_persistent ();
+
+            *l.found = false;
+            continue; // The insert guard removes it from the session.
+          }
 
           object_traits::callback (db, *l.obj, callback_event::pre_load);
 
@@ -106,7 +117,7 @@ namespace odb
           tc.load_ (static_cast<STS&> (*this), *l.obj, false);
 
           if (!delayed_.empty ())
-            load_delayed_<STS> (svm);
+            load_delayed_<STS> (svm, batch);
 
           // Temporarily unlock the statement for the post_load call so that
           // it can load objects of this type recursively. This is safe to do
@@ -129,6 +140,237 @@ namespace odb
       }
     }
 
+    template <typename T>
+    template <typename STS>
+    bool object_statements<T>::
+    load_delayed_batch_ (delayed_loads& dls,
+                         const schema_version_migration* svm)
+    {
+      // Only a single delayed load with the default loader at the end
+      // of the list is not worth batching.
+      //
+      std::size_t n (dls.size ());
+
+      if (n < 2 || dls[n - 1].loader != 0 || dls[n - 2].loader != 0)
+        return false;
+
+      database& db (connection ().database ());
+      object_traits_calls<T> tc (svm);
+
+      // The select binding should be up to date before the statement is
+      // created since it is used to process the statement text.
+      //
+      image_type& im (image_);
+      binding& imb (select_image_binding_);
+
+      if (im.version != select_image_version_ || imb.version == 0)
+      {
+        tc.bind (imb.bind, im, statement_select);
+        select_image_version_ = im.version;
+        imb.version++;
+      }
+
+      if (presize_image (tc, im, imb, select_image_truncated_))
+      {
+        tc.bind (imb.bind, im, statement_select);
+        select_image_version_ = im.version;
+        imb.version++;
+      }
+
+      bulk_select_statement& st (bulk_find_statement ());
+
+      if (!st.valid ())
+        return false;
+
+      // Find the delayed loads at the end of the list that use the
+      // default loader.
+      //
+      std::size_t s (n);
+
+      while (s != 0 && dls[s - 1].loader == 0 && n - s != st.batch ())
+        s--;
+
+      // Add the ids mapping each delayed load to its row. Loads of the
+      // same id share a row.
+      //
+      std::vector<std::size_t> rows (n - s);
+      std::vector<char> loaded (n - s, 0);
+
+      st.clear ();
+
+      for (std::size_t i (s); i != n; ++i)
+      {
+        init_id (dls[i].id);
+
+        std::size_t r (st.find ());
+
+        if (r == st.pending ())
+          st.add ();
+
+        rows[i - s] = r;
+      }
+
+      {
+        select_statement& ss (st.execute ());
+        auto_result ar (ss);
+
+        for (;;)
+        {
+          select_statement::result r (ss.fetch ());
+
+          if (r == select_statement::no_data)
+            break;
+
+          if (r == select_statement::truncated)
+          {
+            record_lengths (imb);
+
+            if (tc.grow (im, select_image_truncated_))
+              im.version++;
+
+            if (im.version != select_image_version_)
+            {
+              tc.bind (imb.bind, im, statement_select);
+              select_image_version_ = im.version;
+              imb.version++;
+              ss.refetch ();
+            }
+          }
+
+          // Our calls to init() can result in additional delayed loads
+          // being added to the delayed_ vector. Those are processed below
+          // when we load the rest of each object.
+          //
+          init_id (object_traits::id (im));
+          std::size_t row (st.find ());
+
+          for (std::size_t i (s); i != n; ++i)
+          {
+            if (rows[i - s] != row || loaded[i - s])
+              continue;
+
+            delayed_load& l (dls[i]);
+            object_traits::callback (db, *l.obj, callback_event::pre_load);
+            tc.init (*l.obj, im, &db);
+            loaded[i - s] = 1;
+          }
+        }
+      }
+
+      st.clear ();
+
+      // Load the rest of each object (containers, etc) the same way as
+      // in load_delayed_(). The loads stay in the list until they are
+      // complete so that they are cleared if an exception is thrown.
+      //
+      for (std::size_t i (n); i != s; --i)
+      {
+        delayed_load& l (dls.back ());
+
+        if (!loaded[i - 1 - s])
+        {
+          // Not returned by the batch, for example, because the id is
+          // equal to the one in the database according to the column
+          // collation but not byte-for-byte. Try to load it by itself.
+          //
+          if (!tc.find_ (static_cast<STS&> (*this), &l.id))
+          {
+            if (l.found == 0)
+              throw object_not_persistent ();
+
+            *l.found = false;
+            pointer_cache_traits::erase (l.pos);
+            dls.pop_back ();
+            continue;
+          }
+
+          object_traits::callback (db, *l.obj, callback_event::pre_load);
+          tc.init (*l.obj, im, &db);
+        }
+        else
+          init_id (l.id);
+
+        tc.load_ (static_cast<STS&> (*this), *l.obj, false);
+
+        if (!delayed_.empty ())
+          load_delayed_<STS> (svm, true);
+
+        {
+          auto_unlock u (*this);
+          object_traits::callback (db, *l.obj, callback_event::post_load);
+        }
+
+        pointer_cache_traits::load (l.pos);
+        dls.pop_back ();
+      }
+
+      return true;
+    }
+
+    template <typename T>
+    void object_statements<T>::
+    init_id (const id_type& id)
+    {
+      object_traits::init (id_image_, id);
+
+      binding& idb (id_image_binding_);
+      if (id_image_.version != id_image_version_ || idb.version == 0)
+      {
+        object_traits::bind (idb.bind, id_image_);
+        id_image_version_ = id_image_.version;
+        idb.version++;
+
+        // The optimistic id binding shares the bind array.
+        //
+        if (binding* ob = od_.id_image_binding ())
+          ob->version++;
+      }
+    }
+
+    template <typename T>
+    bool object_statements<T>::
+    presize_image (object_traits_calls<T>& tc,
+                   image_type& im,
+                   binding& b,
+                   my_bool* truncated)
+    {
+      if (!select_lengths_init_)
+      {
+        conn_.database ().length_cache ().merge (
+          object_traits::find_statement, select_lengths_);
+        select_lengths_init_ = true;
+      }
+
+      if (!length_cache::presize (select_lengths_, b))
+        return false;
+
+      bool r (tc.grow (im, truncated));
+
+      // Clear the flags we have set so that they are not mistaken for
+      // the ones set by the next fetch (they are not reset for NULL
+      // values).
+      //
+      std::memset (truncated, 0, select_column_count * sizeof (my_bool));
+
+      if (r)
+        im.version++;
+
+      return r;
+    }
+
+    template <typename T>
+    void object_statements<T>::
+    record_lengths (const binding& b)
+    {
+      length_cache& c (conn_.database ().length_cache ());
+
+      if (c.record (select_lengths_, b))
+      {
+        c.merge (object_traits::find_statement, select_lengths_);
+        select_lengths_init_ = true;
+      }
+    }
+
     template <typename T>
     void object_statements<T>::
     clear_delayed_ ()
@@ -0,0 +1,42 @@
+// file      : odb/mysql/statement-cache.cxx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#include <odb/details/lock.hxx>
+#include <odb/details/mutex.hxx>
+
+#include <odb/mysql/statement-cache.hxx>
+
+using namespace std;
+
+namespace odb
+{
+  namespace mysql
+  {
+    static details::mutex slot_mutex_;
+    static size_t slot_count_ = 0; // Protected by slot_mutex_.
+
+    size_t statement_cache::
+    assign_slot (slot_index_type& index)
+    {
+      details::lock l (slot_mutex_);
+
+#ifdef LIBODB_MYSQL_CXX11_ATOMIC
+      size_t i (index.load (memory_order_relaxed));
+
+      if (i == 0)
+      {
+        i = ++slot_count_;
+        index.store (i, memory_order_release);
+      }
+
+      return i;
+#else
+      if (index == 0)
+        index = ++slot_count_;
+
+      return index;
+#endif
+    }
+  }
+}
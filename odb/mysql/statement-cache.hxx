@@ -7,8 +7,8 @@
 
 #include <odb/pre.hxx>
 
-#include <map>
-#include <typeinfo>
+#include <vector>
+#include <cstddef> // std::size_t
 
 #include <odb/forward.hxx>
 #include <odb/traits.hxx>
@@ -18,10 +18,14 @@
 #include <odb/mysql/statements-base.hxx>
 
 #include <odb/details/shared-ptr.hxx>
-#include <odb/details/type-info.hxx>
 
+#include <odb/mysql/details/config.hxx> // LIBODB_MYSQL_CXX11_ATOMIC
 #include <odb/mysql/details/export.hxx>
 
+#ifdef LIBODB_MYSQL_CXX11_ATOMIC
+#  include <atomic>
+#endif
+
 namespace odb
 {
   namespace mysql
@@ -43,13 +47,41 @@ namespace odb
       find_view ();
 
     private:
-      typedef std::map<const std::type_info*,
-                       details::shared_ptr<statements_base>,
-                       details::type_info_comparator> map;
+      // Each object and view type is assigned a slot index in the
+      // cache the first time its statements are requested. This way
+      // finding the statements is a vector lookup rather than a map
+      // lookup with type_info comparison. The index is shared by all
+      // the connections and is only written once. With C++11 atomics it
+      // is read with acquire semantics without locking. Otherwise, there
+      // is no portable way to do that so it is read under the lock.
+      //
+#ifdef LIBODB_MYSQL_CXX11_ATOMIC
+      typedef std::atomic<std::size_t> slot_index_type;
+#else
+      typedef std::size_t slot_index_type;
+#endif
+
+      template <typename T>
+      struct slot
+      {
+        static slot_index_type index; // 0 if not yet assigned.
+      };
+
+      template <typename T>
+      static std::size_t
+      slot_index ();
+
+      // Assign the next free index to the slot unless it has already
+      // been assigned by another thread and return the assigned index.
+      //
+      static std::size_t
+      assign_slot (slot_index_type& index);
+
+      typedef std::vector<details::shared_ptr<statements_base> > slots;
 
       connection& conn_;
       unsigned int version_seq_;
-      map map_;
+      slots slots_;
     };
   }
 }
@@ -8,6 +8,28 @@ namespace odb
 {
   namespace mysql
   {
+    template <typename T>
+    statement_cache::slot_index_type statement_cache::slot<T>::index (0);
+
+    template <typename T>
+    inline std::size_t statement_cache::
+    slot_index ()
+    {
+#ifdef LIBODB_MYSQL_CXX11_ATOMIC
+      // The index is only written once so once we see it assigned, we
+      // don't need to synchronize any further.
+      //
+      std::size_t i (slot<T>::index.load (std::memory_order_acquire));
+
+      if (i == 0)
+        i = assign_slot (slot<T>::index);
+#else
+      std::size_t i (assign_slot (slot<T>::index));
+#endif
+
+      return i - 1;
+    }
+
     template <typename T>
     typename object_traits_impl<T, id_mysql>::statements_type&
     statement_cache::
@@ -23,19 +45,22 @@ namespace odb
       //
       if (version_seq_ != conn_.database ().schema_version_sequence ())
       {
-        map_.clear ();
+        slots_.clear ();
         version_seq_ = conn_.database ().schema_version_sequence ();
       }
 
-      map::iterator i (map_.find (&typeid (T)));
+      std::size_t i (slot_index<T> ());
 
-      if (i != map_.end ())
-        return static_cast<statements_type&> (*i->second);
+      if (i < slots_.size () && slots_[i])
+        return static_cast<statements_type&> (*slots_[i]);
 
       details::shared_ptr<statements_type> p (
         new (details::shared) statements_type (conn_));
 
-      map_.insert (map::value_type (&typeid (T), p));
+      if (i >= slots_.size ())
+        slots_.resize (i + 1);
+
+      slots_[i] = p;
       return *p;
     }
 
@@ -46,15 +71,18 @@ namespace odb
       // We don't cache any statements for views so no need to clear
       // the cache.
 
-      map::iterator i (map_.find (&typeid (T)));
+      std::size_t i (slot_index<T> ());
 
-      if (i != map_.end ())
-        return static_cast<view_statements<T>&> (*i->second);
+      if (i < slots_.size () && slots_[i])
+        return static_cast<view_statements<T>&> (*slots_[i]);
 
       details::shared_ptr<view_statements<T> > p (
         new (details::shared) view_statements<T> (conn_));
 
-      map_.insert (map::value_type (&typeid (T), p));
+      if (i >= slots_.size ())
+        slots_.resize (i + 1);
+
+      slots_[i] = p;
       return *p;
     }
   }
@@ -2,7 +2,7 @@
 // copyright : Copyright (c) 2005-2015 Code Synthesis Tools CC
 // license   : GNU GPL v2; see accompanying LICENSE file
 
-#include <cstring> // std::strlen, std::memmove, std::memset
+#include <cstring> // std::strlen, std::memset, std::memcpy, std::memcmp
 #include <cassert>
 
 #include <odb/tracer.hxx>
@@ -11,7 +11,9 @@
 #include <odb/mysql/database.hxx>
 #include <odb/mysql/connection.hxx>
 #include <odb/mysql/statement.hxx>
+#include <odb/mysql/handle-cache.hxx>
 #include <odb/mysql/error.hxx>
+#include <odb/mysql/exceptions.hxx> // batch_failed
 
 using namespace std;
 
@@ -29,6 +31,9 @@ namespace odb
                const binding* process,
                bool optimize)
         : conn_ (conn)
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          , async_ (async_none)
+#endif
     {
       if (process == 0)
       {
@@ -49,6 +54,9 @@ namespace odb
                bool optimize,
                bool copy)
         : conn_ (conn)
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          , async_ (async_none)
+#endif
     {
       size_t n;
 
@@ -64,44 +72,63 @@ namespace odb
         n = strlen (text_);
       }
 
-      init (n, sk, process, optimize);
+      init (n, sk, process, optimize, process != 0 && !copy);
     }
 
     void statement::
     init (size_t text_size,
           statement_kind sk,
           const binding* proc,
-          bool optimize)
+          bool optimize,
+          bool cache)
     {
       if (proc != 0)
       {
-        switch (sk)
+        text_cache* tc (cache ? &conn_.database ().text_cache () : 0);
+        const string* t (tc != 0 ? tc->find (text_, sk, optimize, *proc) : 0);
+
+        if (t == 0)
         {
-        case statement_select:
-          process_select (text_copy_,
-                          text_,
-                          &proc->bind->buffer, proc->count, sizeof (MYSQL_BIND),
-                          '`', '`',
-                          optimize);
-          break;
-        case statement_insert:
-          process_insert (text_copy_,
-                          text_,
-                          &proc->bind->buffer, proc->count, sizeof (MYSQL_BIND),
-                          '?');
-          break;
-        case statement_update:
-          process_update (text_copy_,
-                          text_,
-                          &proc->bind->buffer, proc->count, sizeof (MYSQL_BIND),
-                          '?');
-          break;
-        case statement_delete:
-          assert (false);
+          switch (sk)
+          {
+          case statement_select:
+            process_select (text_copy_,
+                            text_,
+                            &proc->bind->buffer, proc->count,
+                            sizeof (MYSQL_BIND),
+                            '`', '`',
+                            optimize);
+            break;
+          case statement_insert:
+            process_insert (text_copy_,
+                            text_,
+                            &proc->bind->buffer, proc->count,
+                            sizeof (MYSQL_BIND),
+                            '?');
+            break;
+          case statement_update:
+            process_update (text_copy_,
+                            text_,
+                            &proc->bind->buffer, proc->count,
+                            sizeof (MYSQL_BIND),
+                            '?');
+            break;
+          case statement_delete:
+            assert (false);
+          }
+
+          t = tc != 0
+            ? &tc->insert (text_, sk, optimize, *proc, text_copy_)
+            : &text_copy_;
         }
 
-        text_ = text_copy_.c_str ();
-        text_size = text_copy_.size ();
+        // Use the shared copy if we got one.
+        //
+        if (t != &text_copy_)
+          string ().swap (text_copy_);
+
+        text_ = t->c_str ();
+        text_size = t->size ();
       }
 
       // Empty statement.
@@ -109,6 +136,20 @@ namespace odb
       if (*text_ == '\0')
         return;
 
+      // See if we have a handle prepared for this SELECT statement by a
+      // statement that has since been destroyed.
+      //
+      if (sk == statement_select)
+      {
+        MYSQL_STMT* h (conn_.handle_cache ().take (text_, text_size));
+
+        if (h != 0)
+        {
+          stmt_.reset (h);
+          return;
+        }
+      }
+
       stmt_.reset (conn_.alloc_stmt_handle ());
 
       conn_.clear ();
@@ -125,59 +166,28 @@ namespace odb
         translate_error (conn_, stmt_);
     }
 
-    size_t statement::
-    process_bind (MYSQL_BIND* b, size_t n)
+    MYSQL_BIND* statement::
+    compact_bind (const binding& b, size_t& n)
     {
-      size_t shifts (0);
-      for (MYSQL_BIND* e (b + n); b != e;)
+      n = 0;
+      for (size_t i (0); i != b.count; ++i)
       {
-        if (b->buffer == 0)
-        {
-          // It is possible that this array has already been processed
-          // (shared among multiple statements).
-          //
-          if (b->length != 0)
-          {
-            n -= e - b;
-            break;
-          }
-
-          e--;
-
-          // Shift the rest of the entries to the left.
-          //
-          memmove (b, b + 1, (e - b) * sizeof (MYSQL_BIND));
-
-          // Store the original position of the NULL entry at the end.
-          //
-          e->buffer = 0;
-          e->length = reinterpret_cast<unsigned long*> (b + shifts);
-
-          shifts++;
-          continue;
-        }
-
-        b++;
+        if (b.bind[i].buffer != 0)
+          n++;
       }
 
-      return n - shifts;
-    }
-
-    void statement::
-    restore_bind (MYSQL_BIND* b, size_t n)
-    {
-      for (MYSQL_BIND* e (b + n - 1); e->buffer == 0 && e->length != 0;)
-      {
-        MYSQL_BIND* p (reinterpret_cast<MYSQL_BIND*> (e->length));
+      if (n == b.count || n == 0)
+        return b.bind;
 
-        // Shift the entries from the specified position to the right.
-        //
-        memmove (p + 1, p, (e - p) * sizeof (MYSQL_BIND));
+      compact_.resize (n);
 
-        // Restore the original NULL entry.
-        //
-        memset (p, 0, sizeof (MYSQL_BIND));
+      for (size_t i (0), j (0); i != b.count; ++i)
+      {
+        if (b.bind[i].buffer != 0)
+          compact_[j++] = b.bind[i];
       }
+
+      return &compact_[0];
     }
 
     statement::
@@ -212,6 +222,110 @@ namespace odb
     {
     }
 
+    void statement::
+    discard ()
+    {
+      cancel ();
+    }
+
+    void statement::
+    bind_param ()
+    {
+    }
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+    int statement::
+    execute_start ()
+    {
+      int s (conn_.clear_start ());
+
+      async_ = async_clear;
+      return s != 0 ? s : execute_next (0);
+    }
+
+    int statement::
+    execute_cont (int events)
+    {
+      int s, r;
+
+      switch (async_)
+      {
+      case async_clear:
+        {
+          s = conn_.clear_cont (events);
+          r = 0;
+          break;
+        }
+      case async_reset:
+        {
+          my_bool b;
+          s = mysql_stmt_reset_cont (&b, stmt_, events);
+          r = b;
+          break;
+        }
+      case async_execute:
+        {
+          s = mysql_stmt_execute_cont (&r, stmt_, events);
+          break;
+        }
+      case async_none:
+      default:
+        {
+          assert (false);
+          return 0;
+        }
+      }
+
+      return s != 0 ? s : execute_next (r);
+    }
+
+    int statement::
+    execute_next (int r)
+    {
+      if (async_ == async_clear)
+      {
+        async_ = async_reset;
+
+        my_bool b;
+        int s (mysql_stmt_reset_start (&b, stmt_));
+
+        if (s != 0)
+          return s;
+
+        r = b;
+      }
+
+      if (async_ == async_reset)
+      {
+        async_ = async_none;
+
+        if (r != 0)
+          translate_error (conn_, stmt_);
+
+        bind_param ();
+
+        {
+          odb::tracer* t;
+          if ((t = conn_.transaction_tracer ()) ||
+              (t = conn_.tracer ()) ||
+              (t = conn_.database ().tracer ()))
+            t->execute (conn_, *this);
+        }
+
+        async_ = async_execute;
+
+        int s (mysql_stmt_execute_start (&r, stmt_));
+
+        if (s != 0)
+          return s;
+      }
+
+      async_ = async_none;
+      async_result_ = r;
+      return 0;
+    }
+#endif
+
     // select_statement
     //
 
@@ -219,6 +333,14 @@ namespace odb
     ~select_statement ()
     {
       assert (freed_);
+
+      // Return the handle to the connection for reuse by the next
+      // statement with the same text. A handle with a server-side
+      // cursor is not reused since the cursor attributes are set on
+      // execution based on the statement state (see set_cursor()).
+      //
+      if (stmt_ != 0 && cursor_ == 0)
+        conn_.handle_cache ().put (text_, strlen (text_), stmt_);
     }
 
     select_statement::
@@ -238,7 +360,20 @@ namespace odb
           param_ (&param),
           param_version_ (0),
           result_ (result),
-          result_version_ (0)
+          result_version_ (0),
+          bound_ (&result),
+          cursor_ (0),
+          refetched_rows_ (0),
+          refetched_columns_ (0),
+          batch_ (0),
+          window_ (0),
+          window_bind_ (0),
+          window_rows_ (0),
+          window_version_ (0)
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          , fetch_next_ (true),
+          fetch_result_ (no_data)
+#endif
     {
     }
 
@@ -261,7 +396,20 @@ namespace odb
           param_ (&param),
           param_version_ (0),
           result_ (result),
-          result_version_ (0)
+          result_version_ (0),
+          bound_ (&result),
+          cursor_ (0),
+          refetched_rows_ (0),
+          refetched_columns_ (0),
+          batch_ (0),
+          window_ (0),
+          window_bind_ (0),
+          window_rows_ (0),
+          window_version_ (0)
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          , fetch_next_ (true),
+          fetch_result_ (no_data)
+#endif
     {
     }
 
@@ -280,7 +428,20 @@ namespace odb
           rows_ (0),
           param_ (0),
           result_ (result),
-          result_version_ (0)
+          result_version_ (0),
+          bound_ (&result),
+          cursor_ (0),
+          refetched_rows_ (0),
+          refetched_columns_ (0),
+          batch_ (0),
+          window_ (0),
+          window_bind_ (0),
+          window_rows_ (0),
+          window_version_ (0)
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          , fetch_next_ (true),
+          fetch_result_ (no_data)
+#endif
     {
     }
 
@@ -301,7 +462,20 @@ namespace odb
           rows_ (0),
           param_ (0),
           result_ (result),
-          result_version_ (0)
+          result_version_ (0),
+          bound_ (&result),
+          cursor_ (0),
+          refetched_rows_ (0),
+          refetched_columns_ (0),
+          batch_ (0),
+          window_ (0),
+          window_bind_ (0),
+          window_rows_ (0),
+          window_version_ (0)
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          , fetch_next_ (true),
+          fetch_result_ (no_data)
+#endif
     {
     }
 
@@ -310,6 +484,12 @@ namespace odb
     {
       assert (freed_);
 
+      // See if our rows have already been fetched by the multi-owner
+      // statement.
+      //
+      if (batch_ != 0 && batch_->window (*this))
+        return;
+
       conn_.clear ();
 
       end_ = false;
@@ -318,6 +498,26 @@ namespace odb
       if (mysql_stmt_reset (stmt_))
         translate_error (conn_, stmt_);
 
+      set_cursor ();
+      bind_param ();
+
+      {
+        odb::tracer* t;
+        if ((t = conn_.transaction_tracer ()) ||
+            (t = conn_.tracer ()) ||
+            (t = conn_.database ().tracer ()))
+          t->execute (conn_, *this);
+      }
+
+      if (mysql_stmt_execute (stmt_))
+        translate_error (conn_, stmt_);
+
+      executed ();
+    }
+
+    void select_statement::
+    bind_param ()
+    {
       if (param_ != 0 && param_version_ != param_->version)
       {
         // For now cannot have NULL entries.
@@ -327,18 +527,35 @@ namespace odb
 
         param_version_ = param_->version;
       }
+    }
+
+    void select_statement::
+    set_cursor ()
+    {
+      size_t n (conn_.cursor ());
+
+      if (n == cursor_)
+        return;
+
+      unsigned long t (n != 0 ? CURSOR_TYPE_READ_ONLY : CURSOR_TYPE_NO_CURSOR);
+
+      if (mysql_stmt_attr_set (stmt_, STMT_ATTR_CURSOR_TYPE, &t))
+        translate_error (conn_, stmt_);
 
+      if (n != 0)
       {
-        odb::tracer* t;
-        if ((t = conn_.transaction_tracer ()) ||
-            (t = conn_.tracer ()) ||
-            (t = conn_.database ().tracer ()))
-          t->execute (conn_, *this);
+        unsigned long p (static_cast<unsigned long> (n));
+
+        if (mysql_stmt_attr_set (stmt_, STMT_ATTR_PREFETCH_ROWS, &p))
+          translate_error (conn_, stmt_);
       }
 
-      if (mysql_stmt_execute (stmt_))
-        translate_error (conn_, stmt_);
+      cursor_ = n;
+    }
 
+    void select_statement::
+    executed ()
+    {
       // This flag appears to be cleared once we start processing the
       // result, so we have to cache it for free_result() below.
       //
@@ -347,8 +564,55 @@ namespace odb
 #endif
 
       freed_ = false;
-      conn_.active (this);
+
+      // With a server-side cursor the rest of the result stays on the
+      // server so we don't need to be cancelled before other statements
+      // are executed.
+      //
+      if (cursor_ == 0)
+        conn_.active (this);
+    }
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+    int select_statement::
+    execute_start ()
+    {
+      assert (freed_);
+
+      end_ = false;
+      rows_ = 0;
+
+      set_cursor ();
+
+      int r (statement::execute_start ());
+
+      if (r == 0)
+      {
+        if (async_result_ != 0)
+          translate_error (conn_, stmt_);
+
+        executed ();
+      }
+
+      return r;
+    }
+
+    int select_statement::
+    execute_cont (int events)
+    {
+      int r (statement::execute_cont (events));
+
+      if (r == 0)
+      {
+        if (async_result_ != 0)
+          translate_error (conn_, stmt_);
+
+        executed ();
+      }
+
+      return r;
     }
+#endif
 
     void select_statement::
     cache ()
@@ -372,12 +636,123 @@ namespace odb
       }
     }
 
+    void select_statement::
+    window (select_statement& s,
+            binding& b,
+            MYSQL_ROW_OFFSET begin,
+            size_t rows)
+    {
+      assert (freed_ && s.cached_);
+
+      mysql_stmt_row_seek (s.stmt_, begin);
+
+      window_ = &s;
+      window_bind_ = &b;
+      window_rows_ = rows;
+      window_version_ = result_.version;
+
+      memcpy (b.bind, result_.bind, result_.count * sizeof (MYSQL_BIND));
+      b.version++;
+
+      end_ = false;
+      rows_ = 0;
+      freed_ = false;
+    }
+
+    select_statement::result select_statement::
+    fetch_window ()
+    {
+      if (rows_ == window_rows_)
+      {
+        end_ = true;
+        return no_data;
+      }
+
+      // The result binding could have been updated since the last fetch
+      // (e.g., because of truncation).
+      //
+      binding& b (*window_bind_);
+
+      if (window_version_ != result_.version)
+      {
+        memcpy (b.bind, result_.bind, result_.count * sizeof (MYSQL_BIND));
+        window_version_ = result_.version;
+        b.version++;
+      }
+
+      select_statement& s (*window_);
+      s.fetch_begin (b, true);
+      result r (s.fetch_end (mysql_stmt_fetch (s.stmt_), true));
+
+      if (r != no_data)
+        rows_++;
+      else
+        end_ = true;
+
+      return r;
+    }
+
+    void select_statement::
+    seek (size_t row)
+    {
+      assert (cached_ && row <= size_);
+
+      mysql_stmt_data_seek (stmt_, static_cast<my_ulonglong> (row));
+      rows_ = row;
+
+      if (row < size_)
+        end_ = false;
+    }
+
     select_statement::result select_statement::
     fetch (bool next)
     {
-      if (result_version_ != result_.version)
+      if (window_ != 0)
+      {
+        assert (next);
+        return fetch_window ();
+      }
+
+      fetch_begin (result_, next);
+      return fetch_end (mysql_stmt_fetch (stmt_), next);
+    }
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+    int select_statement::
+    fetch_start (bool next)
+    {
+      fetch_begin (result_, next);
+      fetch_next_ = next;
+
+      int r;
+      int s (mysql_stmt_fetch_start (&r, stmt_));
+
+      if (s == 0)
+        fetch_result_ = fetch_end (r, next);
+
+      return s;
+    }
+
+    int select_statement::
+    fetch_cont (int events)
+    {
+      int r;
+      int s (mysql_stmt_fetch_cont (&r, stmt_, events));
+
+      if (s == 0)
+        fetch_result_ = fetch_end (r, fetch_next_);
+
+      return s;
+    }
+#endif
+
+    void select_statement::
+    fetch_begin (binding& b, bool next)
+    {
+      if (bound_ != &b || result_version_ != b.version)
       {
-        size_t count (process_bind (result_.bind, result_.count));
+        size_t count;
+        MYSQL_BIND* bind (compact_bind (b, count));
 
         // Make sure that the number of columns in the result returned by
         // the database matches the number that we expect. A common cause
@@ -386,13 +761,11 @@ namespace odb
         //
         assert (mysql_stmt_field_count (stmt_) == count);
 
-        if (mysql_stmt_bind_result (stmt_, result_.bind))
+        if (mysql_stmt_bind_result (stmt_, bind))
           translate_error (conn_, stmt_);
 
-        if (count != result_.count)
-          restore_bind (result_.bind, result_.count);
-
-        result_version_ = result_.version;
+        bound_ = &b;
+        result_version_ = b.version;
       }
 
       if (!next && rows_ != 0)
@@ -400,9 +773,11 @@ namespace odb
         assert (cached_);
         mysql_stmt_data_seek (stmt_, static_cast<my_ulonglong> (rows_ - 1));
       }
+    }
 
-      int r (mysql_stmt_fetch (stmt_));
-
+    select_statement::result select_statement::
+    fetch_end (int r, bool next)
+    {
       switch (r)
       {
       case 0:
@@ -433,12 +808,27 @@ namespace odb
     void select_statement::
     refetch ()
     {
+      refetch (result_);
+    }
+
+    void select_statement::
+    refetch (binding& r)
+    {
+      // The current row is in the source statement and our columns are
+      // at the beginning of its select list.
+      //
+      if (window_ != 0)
+      {
+        window_->refetch (r);
+        return;
+      }
+
       // Re-fetch columns that were truncated.
       //
       unsigned int col (0);
-      for (size_t i (0); i < result_.count; ++i)
+      for (size_t i (0); i < r.count; ++i)
       {
-        MYSQL_BIND& b (result_.bind[i]);
+        MYSQL_BIND& b (r.bind[i]);
 
         if (b.buffer == 0) // Skip NULL entries.
           continue;
@@ -449,16 +839,109 @@ namespace odb
 
           if (mysql_stmt_fetch_column (stmt_, &b, col, 0))
             translate_error (conn_, stmt_);
+
+          refetched_columns_++;
         }
 
         col++;
       }
+
+      refetched_rows_++;
     }
 
-    void select_statement::
-    free_result ()
+    static size_t
+    fixed_size (enum_field_types t)
     {
-      if (!freed_)
+      switch (t)
+      {
+      case MYSQL_TYPE_TINY:
+        return 1;
+      case MYSQL_TYPE_SHORT:
+      case MYSQL_TYPE_YEAR:
+        return 2;
+      case MYSQL_TYPE_LONG:
+      case MYSQL_TYPE_INT24:
+      case MYSQL_TYPE_FLOAT:
+        return 4;
+      case MYSQL_TYPE_LONGLONG:
+      case MYSQL_TYPE_DOUBLE:
+        return 8;
+      case MYSQL_TYPE_TIME:
+      case MYSQL_TYPE_DATE:
+      case MYSQL_TYPE_DATETIME:
+      case MYSQL_TYPE_TIMESTAMP:
+        return sizeof (MYSQL_TIME);
+      default:
+        return 0;
+      }
+    }
+
+    bool select_statement::
+    copy (const binding& from, binding& to)
+    {
+      assert (from.count == to.count);
+
+      bool r (true);
+
+      for (size_t i (0); i < from.count; ++i)
+      {
+        const MYSQL_BIND& f (from.bind[i]);
+        MYSQL_BIND& t (to.bind[i]);
+
+        if (f.buffer == 0) // Skip NULL entries.
+          continue;
+
+        if (f.is_null != 0)
+        {
+          *t.is_null = *f.is_null;
+
+          if (*f.is_null)
+            continue;
+        }
+
+        // Variable-length values have the length of the data, fixed-
+        // length ones are identified by the buffer type.
+        //
+        if (f.length != 0)
+        {
+          unsigned long n (*f.length);
+          *t.length = n;
+
+          if (n > t.buffer_length)
+          {
+            *t.error = 1;
+            r = false;
+            continue;
+          }
+
+          memcpy (t.buffer, f.buffer, n);
+        }
+        else
+        {
+          size_t n (fixed_size (f.buffer_type));
+          assert (n != 0);
+          memcpy (t.buffer, f.buffer, n);
+        }
+      }
+
+      return r;
+    }
+
+    void select_statement::
+    free_result ()
+    {
+      if (window_ != 0)
+      {
+        // The result belongs to the source statement.
+        //
+        window_ = 0;
+        end_ = true;
+        freed_ = true;
+        rows_ = 0;
+        return;
+      }
+
+      if (!freed_)
       {
         // If this is a stored procedure call, then we have multiple
         // results. The first is the rowset that is the result of the
@@ -487,69 +970,1302 @@ namespace odb
         // prior MySQL versions.
         //
 
-        // Handling OUT parameters requires a special Voodoo dance:
-        // we have to fetch the row itself and we have to call fetch
-        // again and get MYSQL_NO_DATA. Without doing these exact
-        // steps the server simply drops the connection. Go figure.
-        //
-#if MYSQL_VERSION_ID >= 50503
-        if (out_params_)
+        // Handling OUT parameters requires a special Voodoo dance:
+        // we have to fetch the row itself and we have to call fetch
+        // again and get MYSQL_NO_DATA. Without doing these exact
+        // steps the server simply drops the connection. Go figure.
+        //
+#if MYSQL_VERSION_ID >= 50503
+        if (out_params_)
+        {
+          if (mysql_stmt_fetch (stmt_) != MYSQL_NO_DATA)
+            translate_error (conn_, stmt_);
+        }
+#endif
+
+        if (mysql_stmt_free_result (stmt_))
+          translate_error (conn_, stmt_);
+
+#if MYSQL_VERSION_ID >= 50503
+        {
+          int s;
+          while ((s = mysql_stmt_next_result (stmt_)) == 0)
+          {
+            if (mysql_stmt_field_count (stmt_) != 0)
+            {
+              // The same Voodoo dance as above.
+              //
+              if (conn_.handle ()->server_status & SERVER_PS_OUT_PARAMS)
+              {
+                if (mysql_stmt_fetch (stmt_))
+                  translate_error (conn_, stmt_);
+
+                if (mysql_stmt_fetch (stmt_) != MYSQL_NO_DATA)
+                  translate_error (conn_, stmt_);
+              }
+
+              if (mysql_stmt_free_result (stmt_))
+                translate_error (conn_, stmt_);
+            }
+          }
+
+          if (s != -1)
+            translate_error (conn_, stmt_);
+        }
+#endif
+
+        if (conn_.active () == this)
+          conn_.active (0);
+
+        end_ = true;
+        cached_ = false;
+        freed_ = true;
+        rows_ = 0;
+      }
+    }
+
+    void select_statement::
+    cancel ()
+    {
+      // If we cached the result, don't free it just yet.
+      //
+      if (!cached_ || end_)
+        free_result ();
+      else
+        conn_.active (0);
+    }
+
+    // Store the auto-assigned object id in the returning binding.
+    //
+    static void
+    set_id (binding& r, unsigned long long i)
+    {
+      MYSQL_BIND& b (r.bind[0]);
+      void* v (b.buffer);
+
+      switch (b.buffer_type)
+      {
+      case MYSQL_TYPE_TINY:
+        *static_cast<unsigned char*> (v) = static_cast<unsigned char> (i);
+        break;
+      case MYSQL_TYPE_SHORT:
+        *static_cast<unsigned short*> (v) = static_cast<unsigned short> (i);
+        break;
+      case MYSQL_TYPE_LONG:
+        *static_cast<unsigned int*> (v) = static_cast<unsigned int> (i);
+        break;
+      case MYSQL_TYPE_LONGLONG:
+        *static_cast<unsigned long long*> (v) = i;
+        break;
+      default:
+        assert (false); // Auto id column type is not an integer.
+      }
+
+      *b.is_null = false;
+    }
+
+    // bulk_statement
+    //
+
+    // Size of the value bound to a parameter.
+    //
+    static unsigned long
+    value_size (const MYSQL_BIND& b)
+    {
+      switch (b.buffer_type)
+      {
+      case MYSQL_TYPE_TINY:
+        return 1;
+      case MYSQL_TYPE_SHORT:
+      case MYSQL_TYPE_YEAR:
+        return 2;
+      case MYSQL_TYPE_LONG:
+      case MYSQL_TYPE_FLOAT:
+        return 4;
+      case MYSQL_TYPE_LONGLONG:
+      case MYSQL_TYPE_DOUBLE:
+        return 8;
+      case MYSQL_TYPE_DATE:
+      case MYSQL_TYPE_TIME:
+      case MYSQL_TYPE_DATETIME:
+      case MYSQL_TYPE_TIMESTAMP:
+        return static_cast<unsigned long> (sizeof (MYSQL_TIME));
+      default:
+        return b.length != 0 ? *b.length : b.buffer_length;
+      }
+    }
+
+    // Split the id condition in the WHERE clause. If it is a single
+    // column=? expression, return the column, otherwise return an
+    // empty string.
+    //
+    static string
+    condition_column (const string& c)
+    {
+      string::size_type n (c.size ());
+
+      if (n > 2 && c.compare (n - 2, 2, "=?") == 0 &&
+          c.find ('?') == n - 1 &&
+          c.find (" AND ") == string::npos)
+        return string (c, 0, n - 2);
+
+      return string ();
+    }
+
+    // Generate the WHERE clause condition that matches the specified
+    // number of ids.
+    //
+    static string
+    condition_text (const string& cond, const string& column, size_t rows)
+    {
+      string r;
+
+      if (!column.empty ())
+      {
+        r.reserve (column.size () + 5 + rows * 2);
+        r = column;
+        r += " IN (";
+
+        for (size_t i (0); i < rows; ++i)
+        {
+          if (i != 0)
+            r += ',';
+
+          r += '?';
+        }
+
+        r += ')';
+      }
+      else
+      {
+        for (size_t i (0); i < rows; ++i)
+        {
+          if (i != 0)
+            r += " OR ";
+
+          r += '(';
+          r += cond;
+          r += ')';
+        }
+      }
+
+      return r;
+    }
+
+    bulk_statement::
+    ~bulk_statement ()
+    {
+      if (tail_stmt_ != 0)
+      {
+        cur_text_ = tail_text_.c_str ();
+
+        {
+          odb::tracer* t;
+          if ((t = conn_.transaction_tracer ()) ||
+              (t = conn_.tracer ()) ||
+              (t = conn_.database ().tracer ()))
+            t->deallocate (conn_, *this);
+        }
+
+        cur_text_ = text_;
+        conn_.free_stmt_handle (tail_stmt_);
+      }
+    }
+
+    bulk_statement::
+    bulk_statement (connection_type& conn, binding& param, size_t batch)
+        : statement (conn, "", statement_insert, 0, false, false),
+          param_ (param),
+          batch_ (batch),
+          tail_rows_ (0),
+          cur_text_ (text_),
+          rows_ (0),
+          columns_ (0)
+    {
+      assert (batch_ != 0);
+    }
+
+    void bulk_statement::
+    init (const char* text, statement_kind sk, bool process)
+    {
+      // We always make a copy of the text since we need to generate
+      // the multi-row versions from it.
+      //
+      if (process)
+      {
+        switch (sk)
+        {
+        case statement_insert:
+          process_insert (row_text_,
+                          text,
+                          &param_.bind->buffer, param_.count,
+                          sizeof (MYSQL_BIND),
+                          '?');
+          break;
+        case statement_update:
+          process_update (row_text_,
+                          text,
+                          &param_.bind->buffer, param_.count,
+                          sizeof (MYSQL_BIND),
+                          '?');
+          break;
+        case statement_select:
+        case statement_delete:
+          assert (false);
+        }
+      }
+      else
+        row_text_ = text;
+
+      // Make parsing the text easier.
+      //
+      for (string::iterator i (row_text_.begin ()); i != row_text_.end (); ++i)
+      {
+        if (*i == '\n')
+          *i = ' ';
+      }
+    }
+
+    void bulk_statement::
+    prepare ()
+    {
+      text_copy_ = batch_text (batch_);
+      text_ = text_copy_.c_str ();
+      cur_text_ = text_;
+
+      statement::init (text_copy_.size (), statement_insert, 0, false);
+    }
+
+    const char* bulk_statement::
+    text () const
+    {
+      return cur_text_;
+    }
+
+    bool bulk_statement::
+    add ()
+    {
+      // Entries with NULL buffers have been removed from the statement
+      // text (see process_insert() and process_update()) so skip them
+      // here as well.
+      //
+      for (size_t i (0); i < param_.count; ++i)
+      {
+        const MYSQL_BIND& b (param_.bind[i]);
+
+        if (b.buffer == 0)
+          continue;
+
+        my_bool n (b.is_null != 0 && *b.is_null);
+        unsigned long s (n ? 0 : value_size (b));
+
+        // Keep each value aligned for the client library to read it
+        // in place.
+        //
+        size_t a (sizeof (unsigned long long));
+        size_t o ((data_.size () + a - 1) / a * a);
+
+        data_.resize (o + s);
+
+        if (s != 0)
+          memcpy (&data_[o], b.buffer, s);
+
+        offset_.push_back (o);
+        length_.push_back (s);
+        null_.push_back (n);
+      }
+
+      rows_++;
+      columns_ = offset_.size () / rows_;
+
+      return rows_ >= batch_;
+    }
+
+    void bulk_statement::
+    pop ()
+    {
+      assert (rows_ != 0);
+
+      if (--rows_ == 0)
+      {
+        clear ();
+        return;
+      }
+
+      size_t n (rows_ * columns_);
+
+      data_.resize (offset_[n]);
+      offset_.resize (n);
+      length_.resize (n);
+      null_.resize (n);
+    }
+
+    void bulk_statement::
+    clear ()
+    {
+      rows_ = 0;
+      data_.clear ();
+      offset_.clear ();
+      length_.clear ();
+      null_.clear ();
+    }
+
+    size_t bulk_statement::
+    find ()
+    {
+      size_t n (rows_), r (n);
+
+      // Add the current values as a temporary row and compare it to the
+      // others.
+      //
+      add ();
+
+      for (size_t i (0); i < n; ++i)
+      {
+        if (equal (i, n, 0, columns_))
+        {
+          r = i;
+          break;
+        }
+      }
+
+      pop ();
+      return r;
+    }
+
+    MYSQL_STMT* bulk_statement::
+    prepare (size_t rows)
+    {
+      if (rows == batch_)
+      {
+        cur_text_ = text_;
+        return stmt_;
+      }
+
+      if (rows != tail_rows_)
+      {
+        if (tail_stmt_ != 0)
+        {
+          tail_rows_ = 0;
+          conn_.free_stmt_handle (tail_stmt_);
+        }
+
+        tail_text_ = batch_text (rows);
+        tail_stmt_.reset (conn_.alloc_stmt_handle ());
+
+        cur_text_ = tail_text_.c_str ();
+
+        {
+          odb::tracer* t;
+          if ((t = conn_.transaction_tracer ()) ||
+              (t = conn_.tracer ()) ||
+              (t = conn_.database ().tracer ()))
+            t->prepare (conn_, *this);
+        }
+
+        if (mysql_stmt_prepare (tail_stmt_,
+                                tail_text_.c_str (),
+                                static_cast<unsigned long> (
+                                  tail_text_.size ())) != 0)
+          translate_error (conn_, tail_stmt_);
+
+        tail_rows_ = rows;
+      }
+
+      cur_text_ = tail_text_.c_str ();
+      return tail_stmt_;
+    }
+
+    void bulk_statement::
+    bind (MYSQL_BIND& b, size_t row, size_t column)
+    {
+      // Find the type of this column in the single-row binding.
+      //
+      const MYSQL_BIND* p (param_.bind);
+      for (size_t i (0);; ++p)
+      {
+        if (p->buffer != 0 && i++ == column)
+          break;
+      }
+
+      size_t k (row * columns_ + column);
+
+      memset (&b, 0, sizeof (MYSQL_BIND));
+      b.buffer_type = p->buffer_type;
+      b.is_unsigned = p->is_unsigned;
+      b.buffer = data_.empty () ? 0 : &data_[0] + offset_[k];
+      b.buffer_length = length_[k];
+      b.length = &length_[k];
+      b.is_null = &null_[k];
+    }
+
+    bool bulk_statement::
+    equal (size_t r1, size_t r2, size_t column, size_t n) const
+    {
+      for (size_t i (column); i < column + n; ++i)
+      {
+        size_t k1 (r1 * columns_ + i), k2 (r2 * columns_ + i);
+
+        if (null_[k1] != null_[k2] ||
+            length_[k1] != length_[k2] ||
+            (length_[k1] != 0 &&
+             memcmp (&data_[offset_[k1]], &data_[offset_[k2]], length_[k1])))
+          return false;
+      }
+
+      return true;
+    }
+
+    bool bulk_statement::
+    execute (MYSQL_STMT* s, bool dup)
+    {
+      if (mysql_stmt_reset (s))
+        translate_error (conn_, s);
+
+      if (mysql_stmt_bind_param (s, &bind_[0]))
+        translate_error (conn_, s);
+
+      {
+        odb::tracer* t;
+        if ((t = conn_.transaction_tracer ()) ||
+            (t = conn_.tracer ()) ||
+            (t = conn_.database ().tracer ()))
+          t->execute (conn_, *this);
+      }
+
+      if (mysql_stmt_execute (s))
+      {
+        if (dup && mysql_stmt_errno (s) == ER_DUP_ENTRY)
+          return false;
+        else
+          translate_error (conn_, s);
+      }
+
+      return true;
+    }
+
+    // bulk_insert_statement
+    //
+
+    bulk_insert_statement::
+    ~bulk_insert_statement ()
+    {
+    }
+
+    bulk_insert_statement::
+    bulk_insert_statement (connection_type& conn,
+                           const string& text,
+                           bool process,
+                           binding& param,
+                           size_t batch)
+        : bulk_statement (conn, param, batch)
+    {
+      init (text.c_str (), statement_insert, process);
+      prepare ();
+    }
+
+    bulk_insert_statement::
+    bulk_insert_statement (connection_type& conn,
+                           const char* text,
+                           bool process,
+                           binding& param,
+                           size_t batch,
+                           bool)
+        : bulk_statement (conn, param, batch)
+    {
+      init (text, statement_insert, process);
+      prepare ();
+    }
+
+    string bulk_insert_statement::
+    batch_text (size_t rows) const
+    {
+      // The VALUES list is always the last part of the INSERT statement.
+      //
+      string::size_type p (row_text_.rfind ("VALUES"));
+      assert (p != string::npos);
+      p = row_text_.find ('(', p);
+      assert (p != string::npos);
+
+      string::size_type n (row_text_.size () - p);
+
+      string r;
+      r.reserve (row_text_.size () + (rows - 1) * (n + 1));
+      r = row_text_;
+
+      for (size_t i (1); i < rows; ++i)
+      {
+        r += ',';
+        r.append (row_text_, p, n);
+      }
+
+      return r;
+    }
+
+    size_t bulk_insert_statement::
+    execute ()
+    {
+      size_t n (rows_), r (0);
+
+      if (n == 0)
+        return r;
+
+      dup_.assign (n, 0);
+
+      try
+      {
+        if (execute (0, n))
+          r = n;
+        else
+        {
+          // One or more of the rows are duplicates. Insert the rows one
+          // by one to find out which.
+          //
+          for (size_t i (0); i < n; ++i)
+          {
+            if (execute (i, 1))
+              r++;
+            else
+              dup_[i] = 1;
+          }
+        }
+      }
+      catch (...)
+      {
+        clear ();
+        throw;
+      }
+
+      clear ();
+      return r;
+    }
+
+    bool bulk_insert_statement::
+    execute (size_t first, size_t rows)
+    {
+      conn_.clear ();
+
+      MYSQL_STMT* s (prepare (rows));
+
+      bind_.resize (rows * columns_);
+
+      for (size_t r (0), j (0); r < rows; ++r)
+        for (size_t c (0); c < columns_; ++c)
+          bind (bind_[j++], first + r, c);
+
+      return bulk_statement::execute (s, true);
+    }
+
+    // bulk_update_statement
+    //
+
+    bulk_update_statement::
+    ~bulk_update_statement ()
+    {
+    }
+
+    bulk_update_statement::
+    bulk_update_statement (connection_type& conn,
+                           const char* text,
+                           bool process,
+                           binding& param,
+                           size_t id_columns,
+                           size_t batch)
+        : bulk_statement (conn, param, batch),
+          id_columns_ (id_columns)
+    {
+      init (text, statement_update, process);
+
+      // Processing may have removed all the columns in which case the
+      // statement is empty.
+      //
+      if (row_text_.empty ())
+        return;
+
+      // Split UPDATE t SET a=?, b=? WHERE id=? into parts.
+      //
+      string::size_type s (row_text_.find ("SET "));
+      string::size_type w (row_text_.rfind (" WHERE "));
+      assert (s != string::npos && w != string::npos && s < w);
+
+      prefix_.assign (row_text_, 0, s + 4);
+      condition_.assign (row_text_, w + 7, string::npos);
+      in_column_ = condition_column (condition_);
+
+      // Split the SET list on the top-level commas.
+      //
+      size_t depth (0);
+      char quote ('\0');
+      string::size_type b (s + 4);
+
+      for (string::size_type i (b); i <= w; ++i)
+      {
+        char c (i != w ? row_text_[i] : ',');
+
+        if (quote != '\0')
+        {
+          if (c == quote)
+            quote = '\0';
+
+          continue;
+        }
+
+        switch (c)
+        {
+        case '`':
+        case '\'':
+        case '"':
+          {
+            quote = c;
+            break;
+          }
+        case '(':
+          {
+            depth++;
+            break;
+          }
+        case ')':
+          {
+            depth--;
+            break;
+          }
+        case ',':
+          {
+            if (depth != 0)
+              break;
+
+            // Trim the whitespaces.
+            //
+            string::size_type e (i);
+            while (b != e && row_text_[b] == ' ')
+              b++;
+            while (b != e && row_text_[e - 1] == ' ')
+              e--;
+
+            string a (row_text_, b, e - b);
+            string::size_type p (a.find ('='));
+            assert (p != string::npos);
+
+            set_names_.push_back (string (a, 0, p));
+            set_values_.push_back (string (a, p + 1, string::npos));
+
+            b = i + 1;
+            break;
+          }
+        }
+      }
+
+      prepare ();
+    }
+
+    string bulk_update_statement::
+    batch_text (size_t rows) const
+    {
+      string r (prefix_);
+
+      for (size_t i (0); i < set_names_.size (); ++i)
+      {
+        if (i != 0)
+          r += ", ";
+
+        r += set_names_[i];
+        r += "=CASE";
+
+        for (size_t j (0); j < rows; ++j)
+        {
+          r += " WHEN ";
+          r += condition_;
+          r += " THEN ";
+          r += set_values_[i];
+        }
+
+        r += " END";
+      }
+
+      r += " WHERE ";
+      r += condition_text (condition_, in_column_, rows);
+      return r;
+    }
+
+    bool bulk_update_statement::
+    pending_id () const
+    {
+      size_t last (rows_ - 1), c (columns_ - id_columns_);
+
+      for (size_t r (0); r < last; ++r)
+      {
+        if (equal (r, last, c, id_columns_))
+          return true;
+      }
+
+      return false;
+    }
+
+    unsigned long long bulk_update_statement::
+    execute ()
+    {
+      size_t n (rows_);
+      unsigned long long r (0);
+
+      if (n == 0)
+        return r;
+
+      try
+      {
+        conn_.clear ();
+
+        MYSQL_STMT* s (prepare (n));
+
+        // For each SET column we have the id and value for each row
+        // followed by the ids of all the rows in the WHERE clause.
+        //
+        size_t values (columns_ - id_columns_);
+
+        bind_.resize (values * n * (id_columns_ + 1) + n * id_columns_);
+
+        size_t j (0);
+        for (size_t c (0); c < values; ++c)
+        {
+          for (size_t i (0); i < n; ++i)
+          {
+            for (size_t k (0); k < id_columns_; ++k)
+              bind (bind_[j++], i, values + k);
+
+            bind (bind_[j++], i, c);
+          }
+        }
+
+        for (size_t i (0); i < n; ++i)
+          for (size_t k (0); k < id_columns_; ++k)
+            bind (bind_[j++], i, values + k);
+
+        bulk_statement::execute (s, false);
+
+        my_ulonglong a (mysql_stmt_affected_rows (s));
+
+        if (a == static_cast<my_ulonglong> (-1))
+          translate_error (conn_, s);
+
+        r = static_cast<unsigned long long> (a);
+      }
+      catch (...)
+      {
+        clear ();
+        throw;
+      }
+
+      clear ();
+      return r;
+    }
+
+    // bulk_delete_statement
+    //
+
+    bulk_delete_statement::
+    ~bulk_delete_statement ()
+    {
+    }
+
+    bulk_delete_statement::
+    bulk_delete_statement (connection_type& conn,
+                           const char* text,
+                           binding& param,
+                           size_t batch)
+        : bulk_statement (conn, param, batch)
+    {
+      init (text, statement_delete, false);
+
+      string::size_type w (row_text_.rfind (" WHERE "));
+      assert (w != string::npos);
+
+      prefix_.assign (row_text_, 0, w + 7);
+      condition_.assign (row_text_, w + 7, string::npos);
+      in_column_ = condition_column (condition_);
+
+      prepare ();
+    }
+
+    string bulk_delete_statement::
+    batch_text (size_t rows) const
+    {
+      return prefix_ + condition_text (condition_, in_column_, rows);
+    }
+
+    unsigned long long bulk_delete_statement::
+    execute ()
+    {
+      size_t n (rows_);
+      unsigned long long r (0);
+
+      if (n == 0)
+        return r;
+
+      try
+      {
+        conn_.clear ();
+
+        MYSQL_STMT* s (prepare (n));
+
+        bind_.resize (n * columns_);
+
+        for (size_t i (0), j (0); i < n; ++i)
+          for (size_t c (0); c < columns_; ++c)
+            bind (bind_[j++], i, c);
+
+        bulk_statement::execute (s, false);
+
+        my_ulonglong a (mysql_stmt_affected_rows (s));
+
+        if (a == static_cast<my_ulonglong> (-1))
+          translate_error (conn_, s);
+
+        r = static_cast<unsigned long long> (a);
+      }
+      catch (...)
+      {
+        clear ();
+        throw;
+      }
+
+      clear ();
+      return r;
+    }
+
+    // bulk_select_statement
+    //
+
+    const size_t bulk_select_statement::buckets[
+      bulk_select_statement::bucket_count] = {4, 16, 64};
+
+    bulk_select_statement::
+    ~bulk_select_statement ()
+    {
+    }
+
+    bulk_select_statement::
+    bulk_select_statement (connection_type& conn,
+                           const char* text,
+                           bool process,
+                           binding& param,
+                           binding& result)
+        : bulk_statement (conn, param, buckets[bucket_count - 1]),
+          result_ (result),
+          process_ (process)
+    {
+      // The select list is processed by select_statement which relies
+      // on the original line structure so we don't normalize the text.
+      //
+      row_text_ = text;
+
+      string::size_type w (row_text_.rfind ("WHERE "));
+
+      if (w == string::npos || w == 0 ||
+          (row_text_[w - 1] != ' ' && row_text_[w - 1] != '\n'))
+        return;
+
+      condition_.assign (row_text_, w + 6, string::npos);
+
+      // Make sure there is nothing but the id condition after WHERE.
+      //
+      if (condition_.find ('\n') != string::npos)
+        return;
+
+      prefix_.assign (row_text_, 0, w + 6);
+      in_column_ = condition_column (condition_);
+    }
+
+    string bulk_select_statement::
+    batch_text (size_t rows) const
+    {
+      return prefix_ + condition_text (condition_, in_column_, rows);
+    }
+
+    select_statement& bulk_select_statement::
+    execute ()
+    {
+      size_t n (rows_);
+      assert (n != 0 && n <= batch_);
+
+      size_t k (0);
+      while (buckets[k] < n)
+        k++;
+
+      size_t m (buckets[k]);
+      std::vector<MYSQL_BIND>& binds (bucket_bind_[k]);
+      binding& param (bucket_param_[k]);
+
+      if (bucket_stmt_[k] == 0)
+      {
+        binds.resize (m * columns_);
+        param.bind = &binds[0];
+        param.count = binds.size ();
+
+        bucket_stmt_[k].reset (
+          new (details::shared) select_statement (
+            conn_, batch_text (m), process_, false, param, result_));
+      }
+
+      // Pad the statement to the bucket size with the last row.
+      //
+      for (size_t i (0), j (0); i < m; ++i)
+        for (size_t c (0); c < columns_; ++c)
+          bind (binds[j++], i < n ? i : n - 1, c);
+
+      param.version++;
+
+      select_statement& s (*bucket_stmt_[k]);
+      s.execute ();
+
+      // Cache the result so that other statements can be executed while
+      // the rows are being fetched.
+      //
+      s.cache ();
+      return s;
+    }
+
+    // bulk_owner_select_statement
+    //
+
+    const size_t bulk_owner_select_statement::buckets[
+      bulk_owner_select_statement::bucket_count] = {4, 16, 64};
+
+    bulk_owner_select_statement::
+    ~bulk_owner_select_statement ()
+    {
+      free_chunk ();
+    }
+
+    bulk_owner_select_statement::
+    bulk_owner_select_statement (connection_type& conn,
+                                 const char* text,
+                                 bool process,
+                                 binding& param,
+                                 binding& result)
+        : bulk_statement (conn, param, buckets[bucket_count - 1]),
+          result_ (result),
+          process_ (process),
+          generation_ (0),
+          chunk_ (~size_t (0)),
+          chunk_stmt_ (0),
+          owner_length_ (0),
+          owner_null_ (0),
+          owner_error_ (0)
+    {
+      // As in bulk_select_statement, we don't normalize the text since
+      // the select list is processed by select_statement.
+      //
+      string t (text);
+
+      string::size_type w (t.rfind ("WHERE "));
+
+      if (w == string::npos || w == 0 ||
+          (t[w - 1] != ' ' && t[w - 1] != '\n'))
+        return;
+
+      // The id condition is optionally followed by ORDER BY.
+      //
+      string::size_type o (t.find ("ORDER BY ", w));
+      string::size_type e (o != string::npos ? o - 1 : t.size ());
+
+      if (o != string::npos && t[e] != ' ' && t[e] != '\n')
+        return;
+
+      string c (t, w + 6, e - w - 6);
+
+      if (c.find ('\n') != string::npos)
+        return;
+
+      string col (condition_column (c));
+
+      if (col.empty ())
+        return;
+
+      // Add the owner column to the end of the select list.
+      //
+      string::size_type f (t.find ("FROM "));
+
+      while (f != string::npos && f != 0 &&
+             t[f - 1] != ' ' && t[f - 1] != '\n')
+        f = t.find ("FROM ", f + 5);
+
+      if (f == string::npos || f == 0 || f > w)
+        return;
+
+      char sep (t[f - 1]);
+
+      prefix_.assign (t, 0, f - 1);
+      prefix_ += sep == '\n' ? ",\n" : ", ";
+      prefix_ += col;
+      prefix_ += sep;
+      prefix_.append (t, f, w + 6 - f);
+
+      suffix_ = o != string::npos ? t[e] : ' ';
+      suffix_ += "ORDER BY ";
+      suffix_ += col;
+
+      if (o != string::npos)
+      {
+        suffix_ += ", ";
+        suffix_.append (t, o + 9, string::npos);
+      }
+
+      in_column_ = col;
+
+      size_t n (result_.count + 1);
+
+      bind_.resize (n);
+      bind_binding_.bind = &bind_[0];
+      bind_binding_.count = n;
+
+      match_bind_.resize (n);
+      match_binding_.bind = &match_bind_[0];
+      match_binding_.count = n;
+    }
+
+    string bulk_owner_select_statement::
+    batch_text (size_t rows) const
+    {
+      return prefix_ + condition_text (in_column_, in_column_, rows) + suffix_;
+    }
+
+    bool bulk_owner_select_statement::
+    window (select_statement& s)
+    {
+      const owner_block* o (conn_.owners ());
+
+      if (o == 0 || o->id != &param_ || !valid ())
+      {
+        free_chunk ();
+        return false;
+      }
+
+      if (generation_ != o->generation)
+      {
+        // We can only change the id image while one of the owners is
+        // being loaded since we have to restore its id afterwards.
+        //
+        if (o->current == ~size_t (0))
+          return false;
+
+        load (*o);
+      }
+
+      size_t i (find ());
+
+      if (i == rows_ || owner_rows_[i] == ~size_t (0))
+        return false;
+
+      size_t c (i / buckets[bucket_count - 1]);
+
+      if (c != chunk_ && !execute (c))
+        return false;
+
+      s.window (*chunk_stmt_, bind_binding_, owner_begin_[i], owner_rows_[i]);
+
+      // Only return the rows once since they may be outdated if the
+      // object is loaded again.
+      //
+      owner_rows_[i] = ~size_t (0);
+      return true;
+    }
+
+    void bulk_owner_select_statement::
+    load (const owner_block& o)
+    {
+      free_chunk ();
+      clear ();
+
+      // Skip duplicate owners so that each group of rows in the result
+      // belongs to exactly one of them.
+      //
+      for (size_t i (0); i != o.count; ++i)
+      {
+        o.set_id (o.context, i);
+
+        if (find () == rows_)
+          add ();
+      }
+
+      o.set_id (o.context, o.current);
+
+      owner_begin_.assign (rows_, MYSQL_ROW_OFFSET (0));
+      owner_rows_.assign (rows_, 0);
+      generation_ = o.generation;
+    }
+
+    bool bulk_owner_select_statement::
+    execute (size_t chunk)
+    {
+      free_chunk ();
+
+      size_t first (chunk * buckets[bucket_count - 1]);
+      size_t n (rows_ - first);
+
+      if (n > buckets[bucket_count - 1])
+        n = buckets[bucket_count - 1];
+
+      size_t k (0);
+      while (buckets[k] < n)
+        k++;
+
+      size_t m (buckets[k]);
+      std::vector<MYSQL_BIND>& binds (bucket_bind_[k]);
+      binding& param (bucket_param_[k]);
+
+      // Bind the owner column to our buffer which is large enough for
+      // any of the owner ids.
+      //
+      size_t l (sizeof (MYSQL_TIME));
+      for (size_t i (0); i != rows_; ++i)
+      {
+        if (length_[i] > l)
+          l = length_[i];
+      }
+
+      owner_.resize (l);
+
+      size_t d (result_.count);
+      memcpy (&bind_[0], result_.bind, d * sizeof (MYSQL_BIND));
+
+      MYSQL_BIND& ob (bind_[d]);
+      bind (ob, first, 0);
+      ob.buffer = &owner_[0];
+      ob.buffer_length = static_cast<unsigned long> (l);
+      ob.length = &owner_length_;
+      ob.is_null = &owner_null_;
+      ob.error = &owner_error_;
+
+      bind_binding_.version++;
+
+      if (bucket_stmt_[k] == 0)
+      {
+        binds.resize (m * columns_);
+        param.bind = &binds[0];
+        param.count = binds.size ();
+
+        bucket_stmt_[k].reset (
+          new (details::shared) select_statement (
+            conn_, batch_text (m), process_, false, param, bind_binding_));
+      }
+
+      // Pad the statement to the bucket size with the last owner.
+      //
+      for (size_t i (0), j (0); i < m; ++i)
+        for (size_t c (0); c < columns_; ++c)
+          bind (binds[j++], first + (i < n ? i : n - 1), c);
+
+      param.version++;
+
+      select_statement& s (*bucket_stmt_[k]);
+      s.execute ();
+      s.cache ();
+
+      chunk_ = chunk;
+      chunk_stmt_ = &s;
+
+      // Find the range of rows of each owner by fetching only the owner
+      // column. Ignored columns should still have buffers since entries
+      // with NULL buffers are removed from the binding.
+      //
+      memcpy (&match_bind_[0], &bind_[0], (d + 1) * sizeof (MYSQL_BIND));
+
+      for (size_t i (0); i != d; ++i)
+      {
+        if (match_bind_[i].buffer != 0)
+          match_bind_[i].buffer_type = MYSQL_TYPE_NULL;
+      }
+
+      match_binding_.version++;
+
+      std::vector<MYSQL_ROW_OFFSET> begin (n, MYSQL_ROW_OFFSET (0));
+      std::vector<size_t> count (n, 0);
+      size_t cur (n);
+      bool r (true);
+
+      for (;;)
+      {
+        MYSQL_ROW_OFFSET p (mysql_stmt_row_tell (s.handle ()));
+        select_statement::result f (s.fetch (match_binding_));
+
+        if (f == select_statement::no_data)
+          break;
+
+        if (f == select_statement::truncated || owner_error_)
         {
-          if (mysql_stmt_fetch (stmt_) != MYSQL_NO_DATA)
-            translate_error (conn_, stmt_);
+          r = false;
+          break;
         }
-#endif
 
-        if (mysql_stmt_free_result (stmt_))
-          translate_error (conn_, stmt_);
+        unsigned long v (owner_null_ ? 0 : value_size (ob));
 
-#if MYSQL_VERSION_ID >= 50503
+        // Rows are ordered by owner so most of the time it is the same
+        // owner as in the previous row.
+        //
+        if (cur == n ||
+            null_[first + cur] != owner_null_ ||
+            length_[first + cur] != v ||
+            (v != 0 &&
+             memcmp (&data_[offset_[first + cur]], &owner_[0], v) != 0))
         {
-          int s;
-          while ((s = mysql_stmt_next_result (stmt_)) == 0)
+          for (cur = 0; cur != n; ++cur)
           {
-            if (mysql_stmt_field_count (stmt_) != 0)
-            {
-              // The same Voodoo dance as above.
-              //
-              if (conn_.handle ()->server_status & SERVER_PS_OUT_PARAMS)
-              {
-                if (mysql_stmt_fetch (stmt_))
-                  translate_error (conn_, stmt_);
+            size_t i (first + cur);
 
-                if (mysql_stmt_fetch (stmt_) != MYSQL_NO_DATA)
-                  translate_error (conn_, stmt_);
-              }
+            if (null_[i] == owner_null_ &&
+                length_[i] == v &&
+                (v == 0 || memcmp (&data_[offset_[i]], &owner_[0], v) == 0))
+              break;
+          }
 
-              if (mysql_stmt_free_result (stmt_))
-                translate_error (conn_, stmt_);
-            }
+          if (cur == n)
+          {
+            r = false;
+            break;
           }
 
-          if (s != -1)
-            translate_error (conn_, stmt_);
+          begin[cur] = p;
         }
-#endif
 
-        if (conn_.active () == this)
-          conn_.active (0);
+        count[cur]++;
+      }
 
-        end_ = true;
-        cached_ = false;
-        freed_ = true;
-        rows_ = 0;
+      // All the rows have been fetched from the server so there is no
+      // need to cancel the statement before executing others (which
+      // would also free the result since we have reached its end).
+      //
+      if (conn_.active () == &s)
+        conn_.active (0);
+
+      // If some rows don't belong to any of the owners (e.g., because
+      // the server returned the id in a different form), then load the
+      // containers of this chunk one by one.
+      //
+      for (size_t i (0); i != n; ++i)
+      {
+        size_t& o (owner_rows_[first + i]);
+
+        if (o != ~size_t (0))
+        {
+          o = r ? count[i] : ~size_t (0);
+          owner_begin_[first + i] = begin[i];
+        }
       }
+
+      if (!r)
+        free_chunk ();
+
+      return r;
     }
 
-    void select_statement::
-    cancel ()
+    void bulk_owner_select_statement::
+    free_chunk ()
     {
-      // If we cached the result, don't free it just yet.
-      //
-      if (!cached_ || end_)
-        free_result ();
-      else
-        conn_.active (0);
+      if (chunk_stmt_ != 0)
+      {
+        chunk_stmt_->free_result ();
+        chunk_stmt_ = 0;
+        chunk_ = ~size_t (0);
+      }
     }
 
     // insert_statement
@@ -558,6 +2274,10 @@ namespace odb
     insert_statement::
     ~insert_statement ()
     {
+      // Discard the pending batch, if any.
+      //
+      if (conn_.active () == this)
+        conn_.active (0);
     }
 
     insert_statement::
@@ -571,7 +2291,11 @@ namespace odb
                      (process ? &param : 0), false),
           param_ (param),
           param_version_ (0),
-          returning_ (returning)
+          returning_ (returning),
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          inserted_ (false),
+#endif
+          batch_size_ (0)
     {
     }
 
@@ -588,30 +2312,29 @@ namespace odb
                      copy_text),
           param_ (param),
           param_version_ (0),
-          returning_ (returning)
+          returning_ (returning),
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          inserted_ (false),
+#endif
+          batch_size_ (0)
     {
     }
 
     bool insert_statement::
     execute ()
     {
+      // An auto-assigned id has to be returned right away so such rows
+      // cannot be batched.
+      //
+      if (returning_ == 0 && batch_size () > 1)
+        return batch ();
+
       conn_.clear ();
 
       if (mysql_stmt_reset (stmt_))
         translate_error (conn_, stmt_);
 
-      if (param_version_ != param_.version)
-      {
-        size_t count (process_bind (param_.bind, param_.count));
-
-        if (mysql_stmt_bind_param (stmt_, param_.bind))
-          translate_error (conn_, stmt_);
-
-        if (count != param_.count)
-          restore_bind (param_.bind, param_.count);
-
-        param_version_ = param_.version;
-      }
+      bind_param ();
 
       {
         odb::tracer* t;
@@ -621,7 +2344,28 @@ namespace odb
           t->execute (conn_, *this);
       }
 
-      if (mysql_stmt_execute (stmt_))
+      return executed (mysql_stmt_execute (stmt_));
+    }
+
+    void insert_statement::
+    bind_param ()
+    {
+      if (param_version_ != param_.version)
+      {
+        size_t count;
+        MYSQL_BIND* bind (compact_bind (param_, count));
+
+        if (mysql_stmt_bind_param (stmt_, bind))
+          translate_error (conn_, stmt_);
+
+        param_version_ = param_.version;
+      }
+    }
+
+    bool insert_statement::
+    executed (int r)
+    {
+      if (r != 0)
       {
         // An auto-assigned object id should never cause a duplicate
         // primary key.
@@ -633,34 +2377,112 @@ namespace odb
       }
 
       if (returning_ != 0)
-      {
-        unsigned long long i (mysql_stmt_insert_id (stmt_));
+        set_id (*returning_, mysql_stmt_insert_id (stmt_));
 
-        MYSQL_BIND& b (returning_->bind[0]);
-        void* v (b.buffer);
+      return true;
+    }
 
-        switch (b.buffer_type)
-        {
-        case MYSQL_TYPE_TINY:
-          *static_cast<unsigned char*> (v) = static_cast<unsigned char> (i);
-          break;
-        case MYSQL_TYPE_SHORT:
-          *static_cast<unsigned short*> (v) = static_cast<unsigned short> (i);
-          break;
-        case MYSQL_TYPE_LONG:
-          *static_cast<unsigned int*> (v) = static_cast<unsigned int> (i);
-          break;
-        case MYSQL_TYPE_LONGLONG:
-          *static_cast<unsigned long long*> (v) = i;
-          break;
-        default:
-          assert (false); // Auto id column type is not an integer.
-        }
+#ifdef LIBODB_MYSQL_NONBLOCKING
+    int insert_statement::
+    execute_start ()
+    {
+      int r (statement::execute_start ());
+
+      if (r == 0)
+        inserted_ = executed (async_result_);
+
+      return r;
+    }
+
+    int insert_statement::
+    execute_cont (int events)
+    {
+      int r (statement::execute_cont (events));
+
+      if (r == 0)
+        inserted_ = executed (async_result_);
+
+      return r;
+    }
+#endif
+
+    bool insert_statement::
+    batch ()
+    {
+      size_t n (batch_size ());
 
-        *b.is_null = false;
+      // While we have pending rows we are the active statement on the
+      // connection so that any other statement flushes them first.
+      //
+      if (conn_.active () != this)
+        conn_.clear ();
+      else if (bulk_->batch () != n)
+        cancel ();
+
+      if (bulk_.get () == 0 || bulk_->batch () != n)
+        bulk_.reset (
+          new bulk_insert_statement (
+            conn_, text_, false, param_, n, false));
+
+      if (!bulk_->add ())
+      {
+        conn_.active (this);
+        return true;
       }
 
-      return true;
+      // The batch is full and this row is the last one in it.
+      //
+      size_t rows, f (execute_batch (rows));
+
+      if (f == 0)
+        return true;
+
+      if (f == 1 && bulk_->duplicate (rows - 1))
+        return false;
+
+      throw batch_failed (statement_insert, f, rows);
+    }
+
+    size_t insert_statement::
+    execute_batch (size_t& rows)
+    {
+      if (conn_.active () == this)
+        conn_.active (0);
+
+      rows = bulk_->pending ();
+      return rows - bulk_->execute ();
+    }
+
+    bool insert_statement::
+    flush ()
+    {
+      if (bulk_.get () == 0 || bulk_->pending () == 0)
+        return true;
+
+      size_t rows;
+      return execute_batch (rows) == 0;
+    }
+
+    void insert_statement::
+    cancel ()
+    {
+      if (bulk_.get () == 0 || bulk_->pending () == 0)
+        return;
+
+      size_t rows, f (execute_batch (rows));
+
+      if (f != 0)
+        throw batch_failed (statement_insert, f, rows);
+    }
+
+    void insert_statement::
+    discard ()
+    {
+      if (bulk_.get () != 0)
+        bulk_->clear ();
+
+      if (conn_.active () == this)
+        conn_.active (0);
     }
 
     // update_statement
@@ -669,6 +2491,10 @@ namespace odb
     update_statement::
     ~update_statement ()
     {
+      // Discard the pending batch, if any.
+      //
+      if (conn_.active () == this)
+        conn_.active (0);
     }
 
     update_statement::
@@ -680,7 +2506,9 @@ namespace odb
                      text, statement_update,
                      (process ? &param : 0), false),
           param_ (param),
-          param_version_ (0)
+          param_version_ (0),
+          id_columns_ (0),
+          batch_size_ (0)
     {
     }
 
@@ -695,13 +2523,18 @@ namespace odb
                      (process ? &param : 0), false,
                      copy_text),
           param_ (param),
-          param_version_ (0)
+          param_version_ (0),
+          id_columns_ (0),
+          batch_size_ (0)
     {
     }
 
     unsigned long long update_statement::
     execute ()
     {
+      if (id_columns_ != 0 && batch_size () > 1)
+        return batch ();
+
       conn_.clear ();
 
       if (mysql_stmt_reset (stmt_))
@@ -709,14 +2542,12 @@ namespace odb
 
       if (param_version_ != param_.version)
       {
-        size_t count (process_bind (param_.bind, param_.count));
+        size_t count;
+        MYSQL_BIND* bind (compact_bind (param_, count));
 
-        if (mysql_stmt_bind_param (stmt_, param_.bind))
+        if (mysql_stmt_bind_param (stmt_, bind))
           translate_error (conn_, stmt_);
 
-        if (count != param_.count)
-          restore_bind (param_.bind, param_.count);
-
         param_version_ = param_.version;
       }
 
@@ -739,12 +2570,107 @@ namespace odb
       return static_cast<unsigned long long> (r);
     }
 
+    unsigned long long update_statement::
+    batch ()
+    {
+      size_t n (batch_size ());
+
+      // While we have pending rows we are the active statement on the
+      // connection so that any other statement flushes them first.
+      //
+      if (conn_.active () != this)
+        conn_.clear ();
+      else if (bulk_->batch () != n)
+        cancel ();
+
+      if (bulk_.get () == 0 || bulk_->batch () != n)
+        bulk_.reset (
+          new bulk_update_statement (
+            conn_, text_, false, param_, id_columns_, n));
+
+      bool full (bulk_->add ());
+
+      // A statement can only update a row once so if this object is
+      // already pending, flush the batch first.
+      //
+      if (bulk_->pending_id ())
+      {
+        bulk_->pop ();
+        cancel ();
+        full = bulk_->add ();
+      }
+
+      if (!full)
+      {
+        conn_.active (this);
+        return 1;
+      }
+
+      // The batch is full and this row is the last one in it.
+      //
+      size_t rows, f (execute_batch (rows));
+
+      if (f == 0)
+        return 1;
+
+      if (rows == 1)
+        return 0;
+
+      throw batch_failed (statement_update, f, rows);
+    }
+
+    size_t update_statement::
+    execute_batch (size_t& rows)
+    {
+      if (conn_.active () == this)
+        conn_.active (0);
+
+      rows = bulk_->pending ();
+      return rows - static_cast<size_t> (bulk_->execute ());
+    }
+
+    bool update_statement::
+    flush ()
+    {
+      if (bulk_.get () == 0 || bulk_->pending () == 0)
+        return true;
+
+      size_t rows;
+      return execute_batch (rows) == 0;
+    }
+
+    void update_statement::
+    cancel ()
+    {
+      if (bulk_.get () == 0 || bulk_->pending () == 0)
+        return;
+
+      size_t rows, f (execute_batch (rows));
+
+      if (f != 0)
+        throw batch_failed (statement_update, f, rows);
+    }
+
+    void update_statement::
+    discard ()
+    {
+      if (bulk_.get () != 0)
+        bulk_->clear ();
+
+      if (conn_.active () == this)
+        conn_.active (0);
+    }
+
     // delete_statement
     //
 
     delete_statement::
     ~delete_statement ()
     {
+      // Discard the pending batch, if any.
+      //
+      if (conn_.active () == this)
+        conn_.active (0);
     }
 
     delete_statement::
@@ -755,7 +2681,9 @@ namespace odb
                      text, statement_delete,
                      0, false),
           param_ (param),
-          param_version_ (0)
+          param_version_ (0),
+          batchable_ (false),
+          batch_size_ (0)
     {
     }
 
@@ -769,13 +2697,18 @@ namespace odb
                      0, false,
                      copy_text),
           param_ (param),
-          param_version_ (0)
+          param_version_ (0),
+          batchable_ (false),
+          batch_size_ (0)
     {
     }
 
     unsigned long long delete_statement::
     execute ()
     {
+      if (batchable_ && batch_size () > 1)
+        return batch ();
+
       conn_.clear ();
 
       if (mysql_stmt_reset (stmt_))
@@ -809,5 +2742,83 @@ namespace odb
 
       return static_cast<unsigned long long> (r);
     }
+
+    unsigned long long delete_statement::
+    batch ()
+    {
+      size_t n (batch_size ());
+
+      // While we have pending rows we are the active statement on the
+      // connection so that any other statement flushes them first.
+      //
+      if (conn_.active () != this)
+        conn_.clear ();
+      else if (bulk_->batch () != n)
+        cancel ();
+
+      if (bulk_.get () == 0 || bulk_->batch () != n)
+        bulk_.reset (
+          new bulk_delete_statement (conn_, text_, param_, n));
+
+      if (!bulk_->add ())
+      {
+        conn_.active (this);
+        return 1;
+      }
+
+      // The batch is full and this row is the last one in it.
+      //
+      size_t rows, f (execute_batch (rows));
+
+      if (f == 0)
+        return 1;
+
+      if (rows == 1)
+        return 0;
+
+      throw batch_failed (statement_delete, f, rows);
+    }
+
+    size_t delete_statement::
+    execute_batch (size_t& rows)
+    {
+      if (conn_.active () == this)
+        conn_.active (0);
+
+      rows = bulk_->pending ();
+      return rows - static_cast<size_t> (bulk_->execute ());
+    }
+
+    bool delete_statement::
+    flush ()
+    {
+      if (bulk_.get () == 0 || bulk_->pending () == 0)
+        return true;
+
+      size_t rows;
+      return execute_batch (rows) == 0;
+    }
+
+    void delete_statement::
+    cancel ()
+    {
+      if (bulk_.get () == 0 || bulk_->pending () == 0)
+        return;
+
+      size_t rows, f (execute_batch (rows));
+
+      if (f != 0)
+        throw batch_failed (statement_delete, f, rows);
+    }
+
+    void delete_statement::
+    discard ()
+    {
+      if (bulk_.get () != 0)
+        bulk_->clear ();
+
+      if (conn_.active () == this)
+        conn_.active (0);
+    }
   }
 }
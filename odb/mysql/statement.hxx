@@ -8,10 +8,14 @@
 #include <odb/pre.hxx>
 
 #include <string>
+#include <vector>
 #include <cstddef>  // std::size_t
 
 #include <odb/statement.hxx>
 
+#include <odb/details/shared-ptr.hxx>
+#include <odb/details/unique-ptr.hxx>
+
 #include <odb/mysql/mysql.hxx>
 #include <odb/mysql/version.hxx>
 #include <odb/mysql/forward.hxx>
@@ -26,6 +30,7 @@ namespace odb
   namespace mysql
   {
     class connection;
+    class bulk_owner_select_statement;
 
     class LIBODB_MYSQL_EXPORT statement: public odb::statement
     {
@@ -67,6 +72,13 @@ namespace odb
       virtual void
       cancel ();
 
+      // As cancel() but discard instead of executing any work deferred
+      // by the statement (e.g., pending batch rows). Used when the
+      // transaction is rolled back.
+      //
+      virtual void
+      discard ();
+
     protected:
       // We keep two versions to take advantage of std::string COW.
       //
@@ -83,30 +95,69 @@ namespace odb
                  bool optimize,
                  bool copy_text);
 
-      // Process the bind array so that all non-NULL entries are at
-      // the beginning. Return the actual number of bound columns.
+    protected:
+      // Return the bind array without the NULL entries (columns that are
+      // not present in the current schema version) and set count to the
+      // number of the remaining entries. If there are no NULL entries,
+      // then return the original array. Otherwise, return a compacted
+      // copy that stays valid until the next call. The original array,
+      // which can be shared by several statements, is not modified.
       //
-      static std::size_t
-      process_bind (MYSQL_BIND*, std::size_t n);
+      MYSQL_BIND*
+      compact_bind (const binding&, std::size_t& count);
 
-      // Restore the original locations of the NULL entries in the bind
-      // array.
+      // If cache is true, then the text is static and the processed text
+      // can be shared through the database text cache.
       //
-      static void
-      restore_bind (MYSQL_BIND*, std::size_t n);
-
-    private:
       void
       init (std::size_t text_size,
             statement_kind,
             const binding* process,
-            bool optimize);
+            bool optimize,
+            bool cache = false);
+
+      // Bind the parameters, if necessary. Called after the statement
+      // has been reset and before it is executed.
+      //
+      virtual void
+      bind_param ();
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+    protected:
+      // Non-blocking clear, reset, and execute (see connection for
+      // details). The parameters are bound with bind_param() between the
+      // last two. Once completed, the mysql_stmt_execute() return value
+      // is in async_result_.
+      //
+      int
+      execute_start ();
+
+      int
+      execute_cont (int events);
+
+    private:
+      int
+      execute_next (int result);
+#endif
 
     protected:
       connection_type& conn_;
       std::string text_copy_;
       const char* text_;
       auto_handle<MYSQL_STMT> stmt_;
+      std::vector<MYSQL_BIND> compact_; // See compact_bind().
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      enum
+      {
+        async_none,
+        async_clear,
+        async_reset,
+        async_execute
+      } async_;
+
+      int async_result_;
+#endif
     };
 
     class LIBODB_MYSQL_EXPORT select_statement: public statement
@@ -178,6 +229,13 @@ namespace odb
         return rows_;
       }
 
+      // Position a cached result so that the next fetch() returns the
+      // row with the specified index, as if that many rows had been
+      // fetched.
+      //
+      void
+      seek (std::size_t row);
+
       // Fetch next or current row depending on the next argument.
       // Note that fetching of the current row is only supported
       // if the result is cached.
@@ -185,19 +243,119 @@ namespace odb
       result
       fetch (bool next = true);
 
+      // Copy the row last fetched into the from binding into the to
+      // binding, which must be for an image of the same type. Used to
+      // keep several rows while the statement stays bound to the same
+      // image. Return false if some of the to buffers are too small, in
+      // which case their truncation flags and lengths are set as if by
+      // fetch(). The caller should then grow the image, rebind, and
+      // copy again.
+      //
+      static bool
+      copy (const binding& from, binding& to);
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      // Non-blocking versions of execute() and fetch() (see connection
+      // for details). Once fetch_cont() returns 0, the result is
+      // available with fetch_result().
+      //
+      int
+      execute_start ();
+
+      int
+      execute_cont (int events);
+
+      int
+      fetch_start (bool next = true);
+
+      int
+      fetch_cont (int events);
+
+      result
+      fetch_result () const
+      {
+        return fetch_result_;
+      }
+#endif
+
+      // Re-fetch the columns of the current row that were truncated.
+      //
       void
       refetch ();
 
+      void
+      refetch (binding&);
+
+      // Number of rows (and columns in these rows) re-fetched because
+      // some of their columns were truncated.
+      //
+      std::size_t
+      refetched_rows () const
+      {
+        return refetched_rows_;
+      }
+
+      std::size_t
+      refetched_columns () const
+      {
+        return refetched_columns_;
+      }
+
       void
       free_result ();
 
       virtual void
       cancel ();
 
+      // Multi-owner statement that is asked on each execution whether
+      // it has the rows for the current parameter values (see
+      // bulk_owner_select_statement).
+      //
+      void
+      batch (bulk_owner_select_statement* b)
+      {
+        batch_ = b;
+      }
+
+      // Instead of executing this statement, return the specified number
+      // of rows of the cached result of the source statement starting
+      // with the specified row. The source statement's select list must
+      // start with the same columns as ours and the binding passed is
+      // used to fetch its rows. The leading entries of this binding are
+      // kept as copies of our result binding.
+      //
+      void
+      window (select_statement& source,
+              binding&,
+              MYSQL_ROW_OFFSET begin,
+              std::size_t rows);
+
     private:
       select_statement (const select_statement&);
       select_statement& operator= (const select_statement&);
 
+    private:
+      virtual void
+      bind_param ();
+
+      result
+      fetch_window ();
+
+      // Open a server-side cursor on execution if requested on the
+      // connection (see connection::cursor()).
+      //
+      void
+      set_cursor ();
+
+      void
+      executed ();
+
+      void
+      fetch_begin (binding&, bool next);
+
+      result
+      fetch_end (int, bool next);
+
     private:
       bool end_;
       bool cached_;
@@ -214,6 +372,24 @@ namespace odb
 
       binding& result_;
       std::size_t result_version_;
+      binding* bound_; // Binding currently bound to the statement.
+
+      std::size_t cursor_; // Prefetch rows set on the handle, 0 if none.
+
+      std::size_t refetched_rows_;
+      std::size_t refetched_columns_;
+
+      bulk_owner_select_statement* batch_;
+
+      select_statement* window_; // Source of the rows, 0 if none.
+      binding* window_bind_;
+      std::size_t window_rows_;
+      std::size_t window_version_;
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      bool fetch_next_;
+      result fetch_result_;
+#endif
     };
 
     struct LIBODB_MYSQL_EXPORT auto_result
@@ -229,6 +405,444 @@ namespace odb
       select_statement& s_;
     };
 
+    // Base for multi-row statements. Rows are added by copying the
+    // current values of the single-row parameter binding and are sent
+    // to the server as one statement that covers all of them. Partial
+    // batches are executed with a separately prepared statement for
+    // that number of rows.
+    //
+    class LIBODB_MYSQL_EXPORT bulk_statement: public statement
+    {
+    public:
+      virtual
+      ~bulk_statement () = 0;
+
+      static const std::size_t default_batch = 64;
+
+      virtual const char*
+      text () const;
+
+      std::size_t
+      batch () const
+      {
+        return batch_;
+      }
+
+      // Number of rows added but not yet executed.
+      //
+      std::size_t
+      pending () const
+      {
+        return rows_;
+      }
+
+      // Copy the current parameter values as the next row. Return true
+      // if the batch is full and should be executed.
+      //
+      bool
+      add ();
+
+      // Discard the last added row.
+      //
+      void
+      pop ();
+
+      // Discard the pending rows.
+      //
+      void
+      clear ();
+
+      // Return the index of the pending row with the values equal to the
+      // current parameter values or pending() if there is no such row.
+      //
+      std::size_t
+      find ();
+
+    protected:
+      bulk_statement (connection_type&, binding& param, std::size_t batch);
+
+      // Store the processed single-row statement text in row_text_.
+      //
+      void
+      init (const char* text, statement_kind, bool process);
+
+      // Prepare the full batch statement. Should be called by the derived
+      // class constructor once it is ready to generate the text.
+      //
+      void
+      prepare ();
+
+      // Return the statement text for the specified number of rows.
+      //
+      virtual std::string
+      batch_text (std::size_t rows) const = 0;
+
+      // Return the statement handle for the specified number of rows,
+      // preparing it if necessary.
+      //
+      MYSQL_STMT*
+      prepare (std::size_t rows);
+
+      // Bind the value of the specified column of the specified row.
+      // Columns are counted without the NULL entries in the parameter
+      // binding.
+      //
+      void
+      bind (MYSQL_BIND&, std::size_t row, std::size_t column);
+
+      // Return true if the values of the specified column range are
+      // the same in both rows.
+      //
+      bool
+      equal (std::size_t row1, std::size_t row2,
+             std::size_t column, std::size_t n) const;
+
+      // Execute the statement with the bind_ array. If the execution
+      // fails because of a duplicate and dup is true, return false.
+      //
+      bool
+      execute (MYSQL_STMT*, bool dup);
+
+      // Number of bound columns in a row.
+      //
+      std::size_t
+      columns () const
+      {
+        return columns_;
+      }
+
+    private:
+      bulk_statement (const bulk_statement&);
+      bulk_statement& operator= (const bulk_statement&);
+
+    protected:
+      binding& param_;
+      std::size_t batch_;
+
+      // Processed single-row statement text.
+      //
+      std::string row_text_;
+
+      std::vector<MYSQL_BIND> bind_;
+
+      // Statement for partial batches.
+      //
+      std::size_t tail_rows_;
+      std::string tail_text_;
+      auto_handle<MYSQL_STMT> tail_stmt_;
+      const char* cur_text_;
+
+      // Pending rows. The values of all the rows are stored in data_
+      // with the other vectors containing one entry per bound column.
+      //
+      std::size_t rows_;
+      std::size_t columns_;
+      std::vector<char> data_;
+      std::vector<std::size_t> offset_;
+      std::vector<unsigned long> length_;
+      std::vector<my_bool> null_;
+    };
+
+    // Multi-row INSERT ... VALUES (...),(...),... statement.
+    //
+    class LIBODB_MYSQL_EXPORT bulk_insert_statement: public bulk_statement
+    {
+    public:
+      virtual
+      ~bulk_insert_statement ();
+
+      // The text is the single-row INSERT statement. Since the ids
+      // auto-assigned to the rows are not returned, the statement should
+      // not insert objects with auto-assigned ids.
+      //
+      bulk_insert_statement (connection_type& conn,
+                             const std::string& text,
+                             bool process_text,
+                             binding& param,
+                             std::size_t batch);
+
+      bulk_insert_statement (connection_type& conn,
+                             const char* text,
+                             bool process_text,
+                             binding& param,
+                             std::size_t batch,
+                             bool copy_text = true);
+
+      // Insert the pending rows and return the number of rows inserted.
+      // If any of the rows is a duplicate, then the whole statement is
+      // rejected by the server. In this case the rows are re-executed
+      // one by one in order to insert the rest and find the duplicates
+      // which can then be queried with duplicate(). Note that this
+      // relies on the statement-level atomicity of the storage engine
+      // (e.g., InnoDB). All other errors are reported by throwing
+      // exceptions. In all cases the pending rows are discarded.
+      //
+      std::size_t
+      execute ();
+
+      // Results of the last execute() call.
+      //
+      bool
+      duplicate (std::size_t row) const
+      {
+        return dup_[row] != 0;
+      }
+
+    protected:
+      virtual std::string
+      batch_text (std::size_t rows) const;
+
+    private:
+      bool
+      execute (std::size_t first, std::size_t rows);
+
+    private:
+      std::vector<char> dup_;
+    };
+
+    // Multi-row UPDATE statement of the following form:
+    //
+    // UPDATE t SET a=CASE WHEN id=? THEN ? WHEN id=? THEN ? ... END, ...
+    // WHERE id IN (?, ?, ...)
+    //
+    // The single-row statement should be in the UPDATE t SET a=?, ...
+    // WHERE id=? form with each assignment having exactly one parameter
+    // and the id columns coming last in the parameter binding.
+    //
+    class LIBODB_MYSQL_EXPORT bulk_update_statement: public bulk_statement
+    {
+    public:
+      virtual
+      ~bulk_update_statement ();
+
+      bulk_update_statement (connection_type& conn,
+                             const char* text,
+                             bool process_text,
+                             binding& param,
+                             std::size_t id_columns,
+                             std::size_t batch);
+
+      // Return true if the row with the same id as the last added row
+      // is already pending. Such a batch should be executed before the
+      // row is added since a statement can only update a row once.
+      //
+      bool
+      pending_id () const;
+
+      // Update the pending rows and return the number of rows found.
+      // In all cases the pending rows are discarded.
+      //
+      unsigned long long
+      execute ();
+
+    protected:
+      virtual std::string
+      batch_text (std::size_t rows) const;
+
+    private:
+      std::size_t id_columns_;
+
+      std::string prefix_;                   // UPDATE t SET
+      std::vector<std::string> set_names_;   // a
+      std::vector<std::string> set_values_;  // ?
+      std::string condition_;                // id=?
+      std::string in_column_;                // id, if single id column.
+    };
+
+    // Multi-row DELETE ... WHERE id IN (?, ?, ...) statement. The single-
+    // row statement should be in the DELETE FROM t WHERE id=? form. For
+    // composite ids the conditions are combined with OR.
+    //
+    class LIBODB_MYSQL_EXPORT bulk_delete_statement: public bulk_statement
+    {
+    public:
+      virtual
+      ~bulk_delete_statement ();
+
+      bulk_delete_statement (connection_type& conn,
+                             const char* text,
+                             binding& param,
+                             std::size_t batch);
+
+      // Delete the pending rows and return the number of rows deleted.
+      // In all cases the pending rows are discarded.
+      //
+      unsigned long long
+      execute ();
+
+    protected:
+      virtual std::string
+      batch_text (std::size_t rows) const;
+
+    private:
+      std::string prefix_;     // DELETE FROM t WHERE
+      std::string condition_;  // id=?
+      std::string in_column_;  // id, if single id column.
+    };
+
+    // Multi-row SELECT ... WHERE id IN (?, ?, ...) statement that loads
+    // several objects by id with one round trip. The single-row statement
+    // should be in the SELECT ... WHERE id=? form. For composite ids the
+    // conditions are combined with OR. The ids are added by copying the
+    // current values of the id binding. To keep the number of prepared
+    // statements small, the number of ids in the statement is rounded
+    // up to one of the fixed bucket sizes by repeating the last id.
+    //
+    class LIBODB_MYSQL_EXPORT bulk_select_statement: public bulk_statement
+    {
+    public:
+      virtual
+      ~bulk_select_statement ();
+
+      bulk_select_statement (connection_type& conn,
+                             const char* text,
+                             bool process_text,
+                             binding& param,
+                             binding& result);
+
+      // Return false if the single-row statement is not in a form that
+      // can be converted to the multi-row one.
+      //
+      bool
+      valid () const
+      {
+        return !prefix_.empty ();
+      }
+
+      // Execute the statement for the pending rows and cache its result.
+      // The rows are then fetched with the returned statement. Note that
+      // the pending rows are not discarded so that the fetched rows can
+      // be matched with find().
+      //
+      select_statement&
+      execute ();
+
+    protected:
+      virtual std::string
+      batch_text (std::size_t rows) const;
+
+    private:
+      static const std::size_t bucket_count = 3;
+      static const std::size_t buckets[bucket_count];
+
+      binding& result_;
+      bool process_;
+
+      std::string prefix_;     // SELECT ... WHERE
+      std::string condition_;  // id=?
+      std::string in_column_;  // id, if single id column.
+
+      std::vector<MYSQL_BIND> bucket_bind_[bucket_count];
+      binding bucket_param_[bucket_count];
+      details::shared_ptr<select_statement> bucket_stmt_[bucket_count];
+    };
+
+    // Multi-owner SELECT statement of the following form:
+    //
+    // SELECT i, v, id FROM t WHERE id IN (?, ?, ...) ORDER BY id, i
+    //
+    // It is used to load the rows that belong to several objects (for
+    // example, container elements or derived parts of polymorphic
+    // objects) with one statement. The single-owner statement should
+    // be in the SELECT ... FROM ... WHERE id=? [ORDER BY ...] form with
+    // a single id column. The ids of the owners are taken from the
+    // block published on the connection (see connection::owners()).
+    // The statement is executed for up to 64 owners at a time when the
+    // rows of the first of them are needed. The rows of each owner are
+    // then returned by the single-owner statement, without executing
+    // it, when this owner is loaded (see select_statement::window()).
+    // Each owner's rows are only returned once and loading any other
+    // object executes the single-owner statement as usual.
+    //
+    class LIBODB_MYSQL_EXPORT bulk_owner_select_statement:
+      public bulk_statement
+    {
+    public:
+      virtual
+      ~bulk_owner_select_statement ();
+
+      bulk_owner_select_statement (connection_type& conn,
+                                   const char* text,
+                                   bool process_text,
+                                   binding& param,
+                                   binding& result);
+
+      // Return false if the single-owner statement is not in a form that
+      // can be converted to the multi-owner one.
+      //
+      bool
+      valid () const
+      {
+        return !prefix_.empty ();
+      }
+
+      // Set the window of the single-owner statement to the rows of the
+      // owner with the id equal to the current parameter values. Return
+      // false if the rows of this owner are not available.
+      //
+      bool
+      window (select_statement&);
+
+    protected:
+      virtual std::string
+      batch_text (std::size_t rows) const;
+
+    private:
+      // Copy the ids of the published owners.
+      //
+      void
+      load (const owner_block&);
+
+      // Execute the statement for the specified chunk of owners and find
+      // the range of rows of each of them. Return false if some of the
+      // rows could not be matched with the owners.
+      //
+      bool
+      execute (std::size_t chunk);
+
+      void
+      free_chunk ();
+
+    private:
+      static const std::size_t bucket_count = 3;
+      static const std::size_t buckets[bucket_count];
+
+      binding& result_;
+      bool process_;
+
+      std::string prefix_;     // SELECT i, v, id FROM t WHERE
+      std::string in_column_;  // id
+      std::string suffix_;     // ORDER BY id, i
+
+      std::size_t generation_;       // Generation of the loaded owners.
+      std::size_t chunk_;            // Executed chunk or ~0 if none.
+      select_statement* chunk_stmt_; // Statement of the executed chunk.
+
+      // Start and number of rows of each owner in the executed chunk.
+      // The number is ~0 if the owner's rows have already been returned.
+      //
+      std::vector<MYSQL_ROW_OFFSET> owner_begin_;
+      std::vector<std::size_t> owner_rows_;
+
+      // Copies of the data column entries of the result binding followed
+      // by the owner column. In the match binding the data columns are
+      // ignored; it is used to match rows with owners.
+      //
+      std::vector<MYSQL_BIND> bind_;
+      binding bind_binding_;
+      std::vector<MYSQL_BIND> match_bind_;
+      binding match_binding_;
+
+      std::vector<char> owner_;
+      unsigned long owner_length_;
+      my_bool owner_null_;
+      my_bool owner_error_;
+
+      std::vector<MYSQL_BIND> bucket_bind_[bucket_count];
+      binding bucket_param_[bucket_count];
+      details::shared_ptr<select_statement> bucket_stmt_[bucket_count];
+    };
+
     class LIBODB_MYSQL_EXPORT insert_statement: public statement
     {
     public:
@@ -251,18 +865,101 @@ namespace odb
       // Return true if successful and false if the row is a duplicate.
       // All other errors are reported by throwing exceptions.
       //
+      // If batching is enabled (see batch_size() below) and this
+      // statement does not return an auto-assigned id, then the row is
+      // added to the pending batch instead of being executed immediately
+      // and true is returned. When the batch is executed, false is
+      // returned only if this row is its only duplicate. If any earlier
+      // row is a duplicate, then batch_failed is thrown instead.
+      //
       bool
       execute ();
 
+      // Batch size to use for this statement instead of the one set on
+      // the connection. The default is 0 (use connection::batch()).
+      //
+      std::size_t
+      batch_size () const
+      {
+        return batch_size_ != 0 ? batch_size_ : conn_.batch ();
+      }
+
+      void
+      batch_size (std::size_t n)
+      {
+        batch_size_ = n;
+      }
+
+      // Execute the pending batch, if any. Return false if any of the
+      // rows was a duplicate.
+      //
+      bool
+      flush ();
+
+      // Flush the pending batch so that another statement can be
+      // executed on the connection. Throw batch_failed if any of the
+      // rows was a duplicate.
+      //
+      virtual void
+      cancel ();
+
+      // Drop the pending batch without executing it.
+      //
+      virtual void
+      discard ();
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      // Non-blocking version of execute() (see connection for details).
+      // Such an execution is never batched and there should be no rows
+      // pending in a batch, including of this statement. Once
+      // execute_cont() returns 0, the result is available with
+      // execute_result().
+      //
+      int
+      execute_start ();
+
+      int
+      execute_cont (int events);
+
+      bool
+      execute_result () const
+      {
+        return inserted_;
+      }
+#endif
+
     private:
       insert_statement (const insert_statement&);
       insert_statement& operator= (const insert_statement&);
 
+    private:
+      bool
+      batch ();
+
+      // Execute the pending batch. Set rows to the number of rows in
+      // it and return the number of rows that failed.
+      //
+      std::size_t
+      execute_batch (std::size_t& rows);
+
+      virtual void
+      bind_param ();
+
+      bool
+      executed (int result);
+
     private:
       binding& param_;
       std::size_t param_version_;
 
       binding* returning_;
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      bool inserted_;
+#endif
+
+      std::size_t batch_size_;
+      details::unique_ptr<bulk_insert_statement> bulk_;
     };
 
     class LIBODB_MYSQL_EXPORT update_statement: public statement
@@ -282,16 +979,79 @@ namespace odb
                         binding& param,
                         bool copy_text = true);
 
+      // Allow deferring the execution of this statement if batching is
+      // enabled (see batch_size() below). The id columns should come
+      // last in the parameter binding.
+      //
+      void
+      batchable (std::size_t id_columns)
+      {
+        id_columns_ = id_columns;
+      }
+
+      // If the execution is deferred, then 1 is returned. A row that is
+      // not found is only detected when the batch is executed. If this
+      // row is the only one in the batch, then 0 is returned. Otherwise,
+      // it cannot be told which rows were not found and batch_failed is
+      // thrown.
+      //
       unsigned long long
       execute ();
 
+      // Batch size to use for this statement instead of the one set on
+      // the connection. The default is 0 (use connection::batch()).
+      //
+      std::size_t
+      batch_size () const
+      {
+        return batch_size_ != 0 ? batch_size_ : conn_.batch ();
+      }
+
+      void
+      batch_size (std::size_t n)
+      {
+        batch_size_ = n;
+      }
+
+      // Execute the pending batch, if any. Return false if any of the
+      // rows was not found.
+      //
+      bool
+      flush ();
+
+      // Flush the pending batch so that another statement can be
+      // executed on the connection. Throw batch_failed if any of the
+      // rows was not found.
+      //
+      virtual void
+      cancel ();
+
+      // Drop the pending batch without executing it.
+      //
+      virtual void
+      discard ();
+
     private:
       update_statement (const update_statement&);
       update_statement& operator= (const update_statement&);
 
+    private:
+      unsigned long long
+      batch ();
+
+      // Execute the pending batch. Set rows to the number of rows in
+      // it and return the number of rows that were not found.
+      //
+      std::size_t
+      execute_batch (std::size_t& rows);
+
     private:
       binding& param_;
       std::size_t param_version_;
+
+      std::size_t id_columns_; // 0 if not batchable.
+      std::size_t batch_size_;
+      details::unique_ptr<bulk_update_statement> bulk_;
     };
 
     class LIBODB_MYSQL_EXPORT delete_statement: public statement
@@ -309,16 +1069,79 @@ namespace odb
                         binding& param,
                         bool copy_text = true);
 
+      // Allow deferring the execution of this statement if batching is
+      // enabled (see batch_size() below). The statement should delete a
+      // single row by its id.
+      //
+      void
+      batchable (bool b)
+      {
+        batchable_ = b;
+      }
+
+      // If the execution is deferred, then 1 is returned. A row that is
+      // not found is only detected when the batch is executed. If this
+      // row is the only one in the batch, then 0 is returned. Otherwise,
+      // it cannot be told which rows were not found and batch_failed is
+      // thrown.
+      //
       unsigned long long
       execute ();
 
+      // Batch size to use for this statement instead of the one set on
+      // the connection. The default is 0 (use connection::batch()).
+      //
+      std::size_t
+      batch_size () const
+      {
+        return batch_size_ != 0 ? batch_size_ : conn_.batch ();
+      }
+
+      void
+      batch_size (std::size_t n)
+      {
+        batch_size_ = n;
+      }
+
+      // Execute the pending batch, if any. Return false if any of the
+      // rows was not found.
+      //
+      bool
+      flush ();
+
+      // Flush the pending batch so that another statement can be
+      // executed on the connection. Throw batch_failed if any of the
+      // rows was not found.
+      //
+      virtual void
+      cancel ();
+
+      // Drop the pending batch without executing it.
+      //
+      virtual void
+      discard ();
+
     private:
       delete_statement (const delete_statement&);
       delete_statement& operator= (const delete_statement&);
 
+    private:
+      unsigned long long
+      batch ();
+
+      // Execute the pending batch. Set rows to the number of rows in
+      // it and return the number of rows that were not found.
+      //
+      std::size_t
+      execute_batch (std::size_t& rows);
+
     private:
       binding& param_;
       std::size_t param_version_;
+
+      bool batchable_;
+      std::size_t batch_size_;
+      details::unique_ptr<bulk_delete_statement> bulk_;
     };
   }
 }
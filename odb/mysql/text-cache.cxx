@@ -0,0 +1,110 @@
+// file      : odb/mysql/text-cache.cxx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#include <odb/details/lock.hxx>
+
+#include <odb/mysql/mysql.hxx>
+#include <odb/mysql/binding.hxx>
+#include <odb/mysql/text-cache.hxx>
+
+using namespace std;
+
+namespace odb
+{
+  namespace mysql
+  {
+    using namespace details;
+
+    // text_cache::entry
+    //
+
+    bool text_cache::entry::
+    match (statement_kind k, bool o, const binding& b) const
+    {
+      if (kind != k || optimize != o || columns.size () != b.count)
+        return false;
+
+      for (size_t i (0); i != b.count; ++i)
+      {
+        if ((columns[i] == '1') != (b.bind[i].buffer != 0))
+          return false;
+      }
+
+      return true;
+    }
+
+    // text_cache
+    //
+
+    text_cache::
+    text_cache ()
+    {
+    }
+
+    const string* text_cache::
+    find (const char* text, statement_kind k, bool o, const binding& b)
+    {
+      lock l (mutex_);
+
+      map::const_iterator i (map_.find (text));
+
+      if (i != map_.end ())
+      {
+        const entries& es (i->second);
+
+        for (entries::const_iterator j (es.begin ()); j != es.end (); ++j)
+        {
+          if (j->match (k, o, b))
+          {
+            stats_.hits++;
+            return &j->processed;
+          }
+        }
+      }
+
+      stats_.misses++;
+      return 0;
+    }
+
+    const string& text_cache::
+    insert (const char* text,
+            statement_kind k,
+            bool o,
+            const binding& b,
+            const string& processed)
+    {
+      entry e;
+      e.kind = k;
+      e.optimize = o;
+      e.columns.assign (b.count, '0');
+      e.processed = processed;
+
+      for (size_t i (0); i != b.count; ++i)
+      {
+        if (b.bind[i].buffer != 0)
+          e.columns[i] = '1';
+      }
+
+      lock l (mutex_);
+
+      entries& es (map_[text]);
+
+      for (entries::const_iterator j (es.begin ()); j != es.end (); ++j)
+      {
+        if (j->match (k, o, b))
+          return j->processed;
+      }
+
+      es.push_back (e);
+      return es.back ().processed;
+    }
+
+    text_cache::statistics text_cache::
+    stats () const
+    {
+      lock l (mutex_);
+      return stats_;
+    }
+  }
+}
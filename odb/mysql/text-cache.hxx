@@ -0,0 +1,105 @@
+// file      : odb/mysql/text-cache.hxx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#ifndef ODB_MYSQL_TEXT_CACHE_HXX
+#define ODB_MYSQL_TEXT_CACHE_HXX
+
+#include <odb/pre.hxx>
+
+#include <map>
+#include <list>
+#include <string>
+#include <functional> // std::less
+#include <cstddef> // std::size_t
+
+#include <odb/details/mutex.hxx>
+
+#include <odb/mysql/version.hxx>
+#include <odb/mysql/forward.hxx> // statement_kind, binding
+
+#include <odb/mysql/details/export.hxx>
+
+namespace odb
+{
+  namespace mysql
+  {
+    // Database-wide cache of the statement text processed for the
+    // columns that are present (see statement::init()). It allows the
+    // statements for versioned objects that are created on each
+    // connection to share the text processed once instead of processing
+    // it again. The text is identified by its address only (it must be
+    // static) and the processed text depends only on which columns are
+    // present, so it stays valid across schema version changes. The
+    // entries are never removed and the returned text is valid for as
+    // long as the cache exists. The cache is thread-safe.
+    //
+    class LIBODB_MYSQL_EXPORT text_cache
+    {
+    public:
+      text_cache ();
+
+      // Return the processed text stored for this text, statement kind,
+      // optimization flag, and bound columns or 0 if there is none.
+      //
+      const std::string*
+      find (const char* text,
+            statement_kind,
+            bool optimize,
+            const binding& columns);
+
+      // Store the processed text and return the cached copy. If another
+      // thread has stored it first, then return that copy instead.
+      //
+      const std::string&
+      insert (const char* text,
+              statement_kind,
+              bool optimize,
+              const binding& columns,
+              const std::string& processed);
+
+      struct statistics
+      {
+        statistics (): hits (0), misses (0) {}
+
+        std::size_t hits;
+        std::size_t misses;
+      };
+
+      statistics
+      stats () const;
+
+    private:
+      text_cache (const text_cache&);
+      text_cache& operator= (const text_cache&);
+
+    private:
+      // The variants of the same text processed for different statement
+      // kinds, optimization flags, or present columns. There are only a
+      // few of them per text so they are searched linearly. We use list
+      // since the returned processed text must not move.
+      //
+      struct entry
+      {
+        statement_kind kind;
+        bool optimize;
+        std::string columns; // '1' for each present column, '0' otherwise.
+        std::string processed;
+
+        bool
+        match (statement_kind, bool, const binding&) const;
+      };
+
+      typedef std::list<entry> entries;
+      typedef std::map<const char*, entries, std::less<const char*> > map;
+
+      mutable details::mutex mutex_;
+      map map_;            // Protected by mutex_.
+      statistics stats_;   // Protected by mutex_.
+    };
+  }
+}
+
+#include <odb/post.hxx>
+
+#endif // ODB_MYSQL_TEXT_CACHE_HXX
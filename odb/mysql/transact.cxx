@@ -0,0 +1,180 @@
+// file      : odb/mysql/transact.cxx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#include <ctime> // std::time
+
+#ifndef _WIN32
+#  include <time.h> // nanosleep
+#endif
+
+#include <odb/details/lock.hxx>
+
+#include <odb/mysql/mysql.hxx> // Sleep() on Windows
+#include <odb/mysql/transact.hxx>
+
+using namespace std;
+
+namespace odb
+{
+  namespace mysql
+  {
+    using namespace details;
+
+    static void
+    sleep_ms (unsigned int ms)
+    {
+#ifdef _WIN32
+      Sleep (ms);
+#else
+      timespec t;
+      t.tv_sec = ms / 1000;
+      t.tv_nsec = (ms % 1000) * 1000000L;
+      nanosleep (&t, 0);
+#endif
+    }
+
+    //
+    // retry_policy
+    //
+
+    retry_policy::
+    retry_policy (size_t max_retries,
+                  unsigned int initial_delay,
+                  unsigned int max_delay,
+                  double budget,
+                  double budget_ratio)
+        : max_retries_ (max_retries),
+          initial_delay_ (initial_delay),
+          max_delay_ (max_delay),
+          budget_ (budget),
+          budget_ratio_ (budget_ratio),
+          balance_ (budget),
+          random_ (static_cast<unsigned long long> (time (0)) ^
+                   reinterpret_cast<size_t> (this))
+    {
+      if (random_ == 0)
+        random_ = 1;
+    }
+
+    retry_policy::
+    ~retry_policy ()
+    {
+    }
+
+    retry_policy::statistics retry_policy::
+    stats () const
+    {
+      lock l (mutex_);
+      return stats_;
+    }
+
+    bool retry_policy::
+    retry (const recoverable& e, size_t attempt)
+    {
+      unsigned int d;
+
+      {
+        lock l (mutex_);
+
+        if (dynamic_cast<const deadlock*> (&e) != 0)
+          stats_.deadlocks++;
+        else if (dynamic_cast<const connection_lost*> (&e) != 0)
+          stats_.connections_lost++;
+        else if (dynamic_cast<const timeout*> (&e) != 0)
+          stats_.timeouts++;
+
+        if (attempt >= max_retries_)
+        {
+          stats_.failures++;
+          return false;
+        }
+
+        if (balance_ < 1.0)
+        {
+          stats_.exhausted++;
+          stats_.failures++;
+          return false;
+        }
+
+        balance_ -= 1.0;
+        stats_.retries++;
+
+        d = delay (attempt + 1);
+      }
+
+      if (d != 0)
+        sleep_ms (d);
+
+      return true;
+    }
+
+    void retry_policy::
+    fail (const recoverable& e)
+    {
+      lock l (mutex_);
+
+      if (dynamic_cast<const deadlock*> (&e) != 0)
+        stats_.deadlocks++;
+      else if (dynamic_cast<const connection_lost*> (&e) != 0)
+        stats_.connections_lost++;
+      else if (dynamic_cast<const timeout*> (&e) != 0)
+        stats_.timeouts++;
+
+      stats_.failures++;
+    }
+
+    void retry_policy::
+    commit ()
+    {
+      lock l (mutex_);
+
+      stats_.commits++;
+
+      balance_ += budget_ratio_;
+      if (balance_ > budget_)
+        balance_ = budget_;
+    }
+
+    unsigned int retry_policy::
+    delay (size_t retry)
+    {
+      // Exponential backoff cap, saturating at max_delay.
+      //
+      unsigned long long cap (initial_delay_);
+      for (size_t i (1); i < retry && cap < max_delay_; ++i)
+        cap *= 2;
+
+      if (cap > max_delay_)
+        cap = max_delay_;
+
+      if (cap == 0)
+        return 0;
+
+      // Full jitter with the xorshift64* generator.
+      //
+      random_ ^= random_ >> 12;
+      random_ ^= random_ << 25;
+      random_ ^= random_ >> 27;
+      unsigned long long r (random_ * 2685821657736338717ULL);
+
+      return static_cast<unsigned int> (r % (cap + 1));
+    }
+
+    //
+    // retry_policy::statistics
+    //
+
+    retry_policy::statistics::
+    statistics ()
+        : commits (0),
+          failures (0),
+          retries (0),
+          exhausted (0),
+          deadlocks (0),
+          connections_lost (0),
+          timeouts (0)
+    {
+    }
+  }
+}
@@ -0,0 +1,146 @@
+// file      : odb/mysql/transact.hxx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#ifndef ODB_MYSQL_TRANSACT_HXX
+#define ODB_MYSQL_TRANSACT_HXX
+
+#include <odb/pre.hxx>
+
+#include <cstddef> // std::size_t
+
+#include <odb/exceptions.hxx> // odb::recoverable
+#include <odb/details/mutex.hxx>
+
+#include <odb/mysql/version.hxx>
+#include <odb/mysql/forward.hxx>
+#include <odb/mysql/transaction-impl.hxx> // transaction_mode
+
+#include <odb/mysql/details/export.hxx>
+
+namespace odb
+{
+  namespace mysql
+  {
+    // Retry policy for transact(). Decides whether a transaction that
+    // failed with a recoverable exception (deadlock, connection_lost, or
+    // timeout) is rerun, waits before the next attempt, and records the
+    // retry statistics.
+    //
+    // The delay before attempt n (counting from 1 for the first retry)
+    // is chosen randomly between 0 and min (max_delay, initial_delay *
+    // 2^(n-1)) milliseconds so that the transactions that failed at the
+    // same time don't retry at the same time.
+    //
+    // A policy is normally shared by all the transactions of the same
+    // kind (it is thread-safe) in which case it also limits the overall
+    // retry rate with a budget: each retry costs one token, each
+    // committed transaction earns budget_ratio tokens, and the balance
+    // never exceeds budget tokens. Once the budget is exhausted, failed
+    // transactions are not retried until enough of them commit.
+    //
+    class LIBODB_MYSQL_EXPORT retry_policy
+    {
+    public:
+      retry_policy (std::size_t max_retries = 5,
+                    unsigned int initial_delay = 10,
+                    unsigned int max_delay = 1000,
+                    double budget = 10,
+                    double budget_ratio = 0.1);
+
+      virtual
+      ~retry_policy ();
+
+      struct LIBODB_MYSQL_EXPORT statistics
+      {
+        statistics ();
+
+        unsigned long long commits;   // Committed transactions.
+        unsigned long long failures;  // Transactions given up on.
+        unsigned long long retries;   // Attempts after the first.
+        unsigned long long exhausted; // Retries denied by the budget.
+
+        // Retry reasons.
+        //
+        unsigned long long deadlocks;
+        unsigned long long connections_lost;
+        unsigned long long timeouts;
+      };
+
+      statistics
+      stats () const;
+
+      // Called by transact() after attempt (counting from 0 for the
+      // first one) has failed with the specified exception. Return false
+      // if the transaction should not be retried. Otherwise, wait before
+      // the next attempt and return true.
+      //
+      virtual bool
+      retry (const recoverable&, std::size_t attempt);
+
+      // Called by transact() after the transaction has been committed.
+      //
+      virtual void
+      commit ();
+
+      // Called by transact() when it gives up on the transaction without
+      // calling retry() (see transact() for details).
+      //
+      virtual void
+      fail (const recoverable&);
+
+    protected:
+      // Return the delay in milliseconds before the specified retry.
+      //
+      virtual unsigned int
+      delay (std::size_t retry);
+
+    private:
+      retry_policy (const retry_policy&);
+      retry_policy& operator= (const retry_policy&);
+
+    protected:
+      std::size_t max_retries_;
+      unsigned int initial_delay_;
+      unsigned int max_delay_;
+      double budget_;
+      double budget_ratio_;
+
+      mutable details::mutex mutex_;
+      double balance_;             // Protected by mutex_.
+      unsigned long long random_;  // Protected by mutex_.
+      statistics stats_;           // Protected by mutex_.
+    };
+
+    // Run f() in a transaction started with the specified mode (see
+    // transaction_mode) and commit it. If the transaction fails with a
+    // recoverable exception, then rerun it according to the policy.
+    // Each attempt starts a new transaction and, if the connection was
+    // lost, obtains a new connection from the connection factory. Since
+    // f() may be called several times, it should not have any effects
+    // other than on the database (or reset them on each call).
+    //
+    // If the connection is lost while committing, then it is unknown
+    // whether the server has applied the COMMIT. Such a transaction is
+    // not retried so that f() is not run again after its effects have
+    // been committed. Instead, connection_lost is rethrown and it is up
+    // to the caller to check the outcome.
+    //
+    template <typename F>
+    void
+    transact (database&, F f, retry_policy&, unsigned int mode = 0);
+
+    // As above but with the default policy that is not shared with any
+    // other calls.
+    //
+    template <typename F>
+    void
+    transact (database&, F f, unsigned int mode = 0);
+  }
+}
+
+#include <odb/mysql/transact.txx>
+
+#include <odb/post.hxx>
+
+#endif // ODB_MYSQL_TRANSACT_HXX
@@ -0,0 +1,61 @@
+// file      : odb/mysql/transact.txx
+// copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
+// license   : GNU GPL v2; see accompanying LICENSE file
+
+#include <odb/mysql/database.hxx>
+#include <odb/mysql/transaction.hxx>
+
+namespace odb
+{
+  namespace mysql
+  {
+    template <typename F>
+    void
+    transact (database& db, F f, retry_policy& p, unsigned int mode)
+    {
+      for (std::size_t attempt (0);; ++attempt)
+      {
+        bool committing (false);
+
+        try
+        {
+          // A connection that was lost is marked as failed and is not
+          // returned to the pool so the next attempt gets a new one.
+          //
+          transaction t (db.begin (mode));
+          f ();
+          committing = true;
+          t.commit ();
+          break;
+        }
+        catch (const recoverable& e)
+        {
+          // The COMMIT may have been applied before the connection was
+          // lost so running f() again could apply its effects twice.
+          //
+          if (committing && dynamic_cast<const connection_lost*> (&e) != 0)
+          {
+            p.fail (e);
+            throw;
+          }
+
+          // By now the transaction has been rolled back and its
+          // connection released.
+          //
+          if (!p.retry (e, attempt))
+            throw;
+        }
+      }
+
+      p.commit ();
+    }
+
+    template <typename F>
+    inline void
+    transact (database& db, F f, unsigned int mode)
+    {
+      retry_policy p;
+      transact (db, f, p, mode);
+    }
+  }
+}
@@ -2,6 +2,9 @@
 // copyright : Copyright (c) 2009-2015 Code Synthesis Tools CC
 // license   : GNU GPL v2; see accompanying LICENSE file
 
+#include <cstring> // std::strlen
+#include <cassert>
+
 #include <odb/tracer.hxx>
 
 #include <odb/mysql/mysql.hxx>
@@ -10,19 +13,40 @@
 #include <odb/mysql/error.hxx>
 #include <odb/mysql/transaction-impl.hxx>
 
+using namespace std;
+
 namespace odb
 {
   namespace mysql
   {
+    // BEGIN statements indexed by the read_only and consistent_snapshot
+    // mode bits.
+    //
+    static const char* const begin_statements[] =
+    {
+      "BEGIN",
+      "START TRANSACTION READ ONLY",
+      "START TRANSACTION WITH CONSISTENT SNAPSHOT",
+      "START TRANSACTION WITH CONSISTENT SNAPSHOT, READ ONLY"
+    };
+
     transaction_impl::
-    transaction_impl (database_type& db)
-        : odb::transaction_impl (db)
+    transaction_impl (database_type& db, unsigned int mode)
+        : odb::transaction_impl (db), mode_ (mode)
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          , async_ (async_none)
+#endif
     {
     }
 
     transaction_impl::
-    transaction_impl (connection_ptr c)
-        : odb::transaction_impl (c->database (), *c), connection_ (c)
+    transaction_impl (connection_ptr c, unsigned int mode)
+        : odb::transaction_impl (c->database (), *c),
+          connection_ (c),
+          mode_ (mode)
+#ifdef LIBODB_MYSQL_NONBLOCKING
+          , async_ (async_none)
+#endif
     {
     }
 
@@ -31,6 +55,13 @@ namespace odb
     {
     }
 
+    const char* transaction_impl::
+    begin_statement (unsigned int mode)
+    {
+      return begin_statements[
+        mode & (transaction_read_only | transaction_consistent_snapshot)];
+    }
+
     void transaction_impl::
     start ()
     {
@@ -42,28 +73,81 @@ namespace odb
         odb::transaction_impl::connection_ = connection_.get ();
       }
 
+      const char* s (begin_statement (mode_));
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      // BEGIN has already been sent with connection::begin_start(). It
+      // must have been sent for the same mode. Since it has been sent,
+      // the lazy mode bit has no effect.
+      //
+      if (connection_->begun_)
+      {
+        assert (connection_->begun_statement_ == s);
+        connection_->begun_ = false;
+        return;
+      }
+#endif
+
+      // Let the connection send BEGIN before the first statement (see
+      // connection::clear()).
+      //
+      if ((mode_ & transaction_lazy) != 0)
+      {
+        connection_->begin_ = s;
+        return;
+      }
+
       {
         odb::tracer* t;
         if ((t = connection_->tracer ()) || (t = database_.tracer ()))
-          t->execute (*connection_, "BEGIN");
+          t->execute (*connection_, s);
       }
 
-      if (mysql_real_query (connection_->handle (), "begin", 5) != 0)
+      if (mysql_real_query (connection_->handle (),
+                            s,
+                            static_cast<unsigned long> (strlen (s))) != 0)
         translate_error (*connection_);
     }
 
     void transaction_impl::
     commit ()
     {
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      if (async_ == async_commit)
+      {
+        async_ = async_none;
+        connection_.reset ();
+        return;
+      }
+#endif
+
+      // If BEGIN hasn't been sent yet, then there is nothing to commit.
+      //
+      if (connection_->begin_ != 0)
+      {
+        connection_->begin_ = 0;
+        connection_.reset ();
+        return;
+      }
+
       // Invalidate query results.
       //
       connection_->invalidate_results ();
 
       // Cancel and clear the active statement if any. This normally
       // should happen automatically, however, if an exception is
-      // thrown, this may not be the case.
+      // thrown, this may not be the case. This also executes the
+      // pending batch rows, if any, which may fail.
       //
-      connection_->clear ();
+      try
+      {
+        connection_->clear ();
+      }
+      catch (...)
+      {
+        abort ();
+        throw;
+      }
 
       {
         odb::tracer* t;
@@ -82,15 +166,34 @@ namespace odb
     void transaction_impl::
     rollback ()
     {
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      if (async_ == async_rollback)
+      {
+        async_ = async_none;
+        connection_.reset ();
+        return;
+      }
+#endif
+
+      // If BEGIN hasn't been sent yet, then there is nothing to roll back.
+      //
+      if (connection_->begin_ != 0)
+      {
+        connection_->begin_ = 0;
+        connection_.reset ();
+        return;
+      }
+
       // Invalidate query results.
       //
       connection_->invalidate_results ();
 
       // Cancel and clear the active statement if any. This normally
       // should happen automatically, however, if an exception is
-      // thrown, this may not be the case.
+      // thrown, this may not be the case. The pending batch rows, if
+      // any, are discarded rather than executed.
       //
-      connection_->clear ();
+      connection_->discard ();
 
       {
         odb::tracer* t;
@@ -105,5 +208,117 @@ namespace odb
       //
       connection_.reset ();
     }
+
+    void transaction_impl::
+    abort ()
+    {
+      // The transaction is finalized even if commit() throws so there
+      // will be no call to rollback(). Roll back here so that the
+      // connection is not returned to the pool in the middle of the
+      // transaction. If that fails as well, then mark the connection
+      // as failed so that it is closed instead.
+      //
+      try
+      {
+        connection_->discard ();
+
+        {
+          odb::tracer* t;
+          if ((t = connection_->tracer ()) || (t = database_.tracer ()))
+            t->execute (*connection_, "ROLLBACK");
+        }
+
+        if (mysql_real_query (connection_->handle (), "rollback", 8) != 0)
+          connection_->mark_failed ();
+      }
+      catch (...)
+      {
+        connection_->mark_failed ();
+      }
+
+      connection_.reset ();
+    }
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+    int transaction_impl::
+    commit_start ()
+    {
+      if (connection_->begin_ != 0)
+      {
+        connection_->begin_ = 0;
+        async_ = async_commit;
+        return 0;
+      }
+
+      connection_->invalidate_results ();
+
+      // Pending batch rows cannot be flushed without blocking (see
+      // connection for details).
+      //
+      assert (connection_->active_ == 0);
+
+      {
+        odb::tracer* t;
+        if ((t = connection_->tracer ()) || (t = database_.tracer ()))
+          t->execute (*connection_, "COMMIT");
+      }
+
+      int r (connection_->query_start ("commit", 6));
+
+      if (r == 0)
+        async_ = async_commit;
+
+      return r;
+    }
+
+    int transaction_impl::
+    commit_cont (int events)
+    {
+      int r (connection_->query_cont (events));
+
+      if (r == 0)
+        async_ = async_commit;
+
+      return r;
+    }
+
+    int transaction_impl::
+    rollback_start ()
+    {
+      if (connection_->begin_ != 0)
+      {
+        connection_->begin_ = 0;
+        async_ = async_rollback;
+        return 0;
+      }
+
+      connection_->invalidate_results ();
+      connection_->discard ();
+
+      {
+        odb::tracer* t;
+        if ((t = connection_->tracer ()) || (t = database_.tracer ()))
+          t->execute (*connection_, "ROLLBACK");
+      }
+
+      int r (connection_->query_start ("rollback", 8));
+
+      if (r == 0)
+        async_ = async_rollback;
+
+      return r;
+    }
+
+    int transaction_impl::
+    rollback_cont (int events)
+    {
+      int r (connection_->query_cont (events));
+
+      if (r == 0)
+        async_ = async_rollback;
+
+      return r;
+    }
+#endif
   }
 }
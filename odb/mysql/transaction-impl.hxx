@@ -12,20 +12,38 @@
 #include <odb/mysql/version.hxx>
 #include <odb/mysql/forward.hxx>
 
+#include <odb/mysql/details/config.hxx> // LIBODB_MYSQL_NONBLOCKING
 #include <odb/mysql/details/export.hxx>
 
 namespace odb
 {
   namespace mysql
   {
+    // Transaction start modes (see database::begin()). The modes can be
+    // combined. The read_only and consistent_snapshot modes start the
+    // transaction with the corresponding START TRANSACTION
+    // characteristics (read_only requires MySQL 5.6.5 or later). In the
+    // lazy mode BEGIN is only sent to the server before the first
+    // statement is executed in the transaction. If no statements are
+    // executed, then the transaction is committed or rolled back without
+    // any round trips to the server.
+    //
+    enum transaction_mode
+    {
+      transaction_read_write = 0x00,
+      transaction_read_only = 0x01,
+      transaction_consistent_snapshot = 0x02,
+      transaction_lazy = 0x04
+    };
+
     class LIBODB_MYSQL_EXPORT transaction_impl: public odb::transaction_impl
     {
     public:
       typedef mysql::database database_type;
       typedef mysql::connection connection_type;
 
-      transaction_impl (database_type&);
-      transaction_impl (connection_ptr);
+      transaction_impl (database_type&, unsigned int mode = 0);
+      transaction_impl (connection_ptr, unsigned int mode = 0);
 
       virtual
       ~transaction_impl ();
@@ -39,11 +57,60 @@ namespace odb
       virtual void
       rollback ();
 
+      // Return the statement that starts a transaction in the specified
+      // mode. The lazy mode bit is ignored.
+      //
+      static const char*
+      begin_statement (unsigned int mode);
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      // Non-blocking COMMIT and ROLLBACK (see connection for details).
+      // Once completed, the corresponding transaction::commit() or
+      // transaction::rollback() call finalizes the transaction without
+      // a round trip to the server. The pending batch rows should be
+      // flushed before calling commit_start() since that cannot be done
+      // without blocking. rollback_start() discards them.
+      //
+      int
+      commit_start ();
+
+      int
+      commit_cont (int events);
+
+      int
+      rollback_start ();
+
+      int
+      rollback_cont (int events);
+#endif
+
       connection_type&
       connection ();
 
+      unsigned int
+      mode () const
+      {
+        return mode_;
+      }
+
+    private:
+      // Roll back after the pending work failed to execute on commit.
+      //
+      void
+      abort ();
+
     private:
       connection_ptr connection_;
+      unsigned int mode_;
+
+#ifdef LIBODB_MYSQL_NONBLOCKING
+      enum
+      {
+        async_none,
+        async_commit,
+        async_rollback
+      } async_;
+#endif
     };
   }
 }